@@ -0,0 +1,43 @@
+#version 330
+
+// Every layer of the parallax background composited back to front, see RenderSystem::parallax_layers
+
+// must match PARALLAX_LAYER_COUNT
+#define LAYER_COUNT 8
+
+in vec2 position;
+
+uniform sampler2D layers[LAYER_COUNT];
+// top left corner and size of each layer's texture in window pixels
+uniform vec4 layer_rects[LAYER_COUNT];
+// velocity in pixels per second, then 1 along the axes the layer tiles on
+uniform vec4 layer_scrolls[LAYER_COUNT];
+uniform float time;
+
+// Output color
+layout(location = 0) out vec4 color;
+
+// Sampler arrays may only be indexed by constants in 3.30, so the sampler is passed apart from its index
+vec3 over(vec3 below, sampler2D layer, int i)
+{
+	vec2 uv = (position - layer_rects[i].xy - layer_scrolls[i].xy * time) / layer_rects[i].zw;
+	uv = mix(uv, fract(uv), layer_scrolls[i].zw);
+	if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+		return below;
+	vec4 texel = texture(layer, uv);
+	return mix(below, texel.rgb, texel.a);
+}
+
+void main()
+{
+	vec3 scene = vec3(0.0);
+	scene = over(scene, layers[0], 0);
+	scene = over(scene, layers[1], 1);
+	scene = over(scene, layers[2], 2);
+	scene = over(scene, layers[3], 3);
+	scene = over(scene, layers[4], 4);
+	scene = over(scene, layers[5], 5);
+	scene = over(scene, layers[6], 6);
+	scene = over(scene, layers[7], 7);
+	color = vec4(scene, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 330
+
+// Input attributes
+in vec3 in_position;
+
+// window pixels the scene is drawn at
+uniform vec2 view_size;
+
+// Passed to fragment shader, the fragment's position in window pixels, y down like the game's
+out vec2 position;
+
+void main()
+{
+	gl_Position = vec4(in_position.xy, 0, 1.0);
+	position = vec2(in_position.x + 1.0, 1.0 - in_position.y) / 2.0 * view_size;
+}
@@ -1,13 +1,44 @@
 #version 330
 
 uniform sampler2D screen_texture;
+uniform sampler2D dialogue_texture;
+
+// Filled by RenderSystem::drawPostProcess, see PostParams in render_system.hpp
+layout(std140) uniform PostParams
+{
+	float dialogue_dim;
+	float screen_dim;
+	int has_dialogue_layer;
+	int sharp_bilinear;
+	vec2 source_size;
+	vec2 output_size;
+};
 
 in vec2 texcoord;
 
 layout(location = 0) out vec4 color;
 
+// Upscales the largest whole factor with nearest neighbour and filters only the rest, where source
+// pixels straddle output pixels
+vec4 sample_source(sampler2D source, vec2 uv)
+{
+	if (sharp_bilinear == 0)
+		return texture(source, uv);
+	vec2 texel = uv * source_size;
+	vec2 scale = max(floor(output_size / source_size), vec2(1.0));
+	vec2 region = 0.5 - 0.5 / scale;
+	vec2 from_center = fract(texel) - 0.5;
+	vec2 blend = (from_center - clamp(from_center, -region, region)) * scale + 0.5;
+	return texture(source, (floor(texel) + blend) / source_size);
+}
 
 void main()
 {
-    color = texture(screen_texture, texcoord);
-}
\ No newline at end of file
+	vec3 scene = sample_source(screen_texture, texcoord).rgb * (1.0 - dialogue_dim);
+	if (has_dialogue_layer != 0) {
+		// premultiplied, see the blend function set in RenderSystem::draw
+		vec4 dialogue = sample_source(dialogue_texture, texcoord);
+		scene = scene * (1.0 - dialogue.a) + dialogue.rgb;
+	}
+	color = vec4(scene * (1.0 - screen_dim), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330
+
+#include "sprite_features.glsl"
+
+// From vertex shader
+in vec2 texcoord;
+in vec2 local_texcoord;
+in vec3 tint;
+flat in vec2 feature_params;
+
+// Application data
+uniform sampler2D sampler0;
+
+// Output color
+layout(location = 0) out  vec4 color;
+
+void main()
+{
+	color = vec4(tint, 1.0) * texture(sampler0, texcoord);
+	color = apply_sprite_features(color, local_texcoord, feature_params);
+}
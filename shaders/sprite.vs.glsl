@@ -0,0 +1,52 @@
+#version 330
+
+// Sprite uber-shader, built once per variant listed in RenderSystem::effect_sources.
+// INSTANCED reads everything about a sprite from the per instance attributes, see
+// RenderSystem::SpriteInstance, otherwise it comes from uniforms and one sprite is drawn per call.
+
+// Input attributes
+in vec3 in_position;
+in vec2 in_texcoord;
+
+#ifdef INSTANCED
+// Per instance attributes
+layout(location = 3) in mat3 in_transform;
+layout(location = 6) in vec3 in_tint;
+layout(location = 7) in vec4 in_uv_rect;
+layout(location = 8) in vec2 in_params;
+#else
+// Application data
+uniform mat3 transform;
+uniform vec3 fcolor;
+// the part of the texture shown, the sprite sheet cell for animations
+uniform vec4 uv_rect = vec4(0.0, 0.0, 1.0, 1.0);
+// see sprite_features.glsl
+uniform vec2 params = vec2(0.0, 1.0);
+#endif
+
+// Passed to fragment shader
+out vec2 texcoord;
+out vec2 local_texcoord;
+out vec3 tint;
+flat out vec2 feature_params;
+
+uniform mat3 projection;
+
+void main()
+{
+#ifdef INSTANCED
+	mat3 model = in_transform;
+	vec4 rect = in_uv_rect;
+	tint = in_tint;
+	feature_params = in_params;
+#else
+	mat3 model = transform;
+	vec4 rect = uv_rect;
+	tint = fcolor;
+	feature_params = params;
+#endif
+	texcoord = rect.xy + in_texcoord * rect.zw;
+	local_texcoord = in_texcoord;
+	vec3 pos = projection * model * vec3(in_position.xy, 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
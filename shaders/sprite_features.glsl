@@ -0,0 +1,20 @@
+// Optional sprite effects, each compiled in by its define. Their parameters come per sprite:
+// params.x is the hero's invulnerability timer in ms (0 when not flashing),
+// params.y is how much of a health bar is filled, from 0 to 1 (1 for everything else)
+
+const float M_PI = 3.14159265;
+
+vec4 apply_sprite_features(vec4 color, vec2 local_texcoord, vec2 params)
+{
+#ifdef FEATURE_FLASH
+	if (params.x > 0) {
+		color *= vec4(0.3 + abs(cos(M_PI - M_PI * params.x / 3000.f)) / 0.5, 0, 0, 1);
+	}
+#endif
+#ifdef FEATURE_HEALTH_CUT
+	if (local_texcoord.x > params.y) {
+		color.a = 0;
+	}
+#endif
+	return color;
+}
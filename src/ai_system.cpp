@@ -1,5 +1,8 @@
 // internal
 #include "ai_system.hpp"
+#include "world_init.hpp"
+#include "world_system.hpp"
+#include "physics_system.hpp"
 #include <unordered_set>
 #include <queue>
 #include <map>
@@ -32,9 +35,448 @@ struct cmpVec2 {
 };
 
 
-void AISystem::step(float elapsed_ms)
+AISystem::AISystem()
 {
-	(void)elapsed_ms; // placeholder to silence unused warning until implemented
+	for (int i = 0; i < (int) AI_ARCHETYPE::ARCHETYPE_COUNT; i++)
+		schedules[i] = { AI_THINK_INTERVAL_MS[i], 0.f, 0 };
+}
+
+void AISystem::init(RenderSystem* renderer_arg)
+{
+	this->renderer = renderer_arg;
+}
+
+void AISystem::set_think_rate(AI_ARCHETYPE archetype, float hz)
+{
+	ThinkSchedule& schedule = schedules[(int) archetype];
+	schedule.interval_ms = hz > 0 ? 1000.f / hz : 0.f;
+	schedule.pending = 0;
+}
+
+void AISystem::cycle_think_rates()
+{
+	think_rate_preset = (think_rate_preset + 1) % (AI_DEBUG_THINK_RATE_COUNT + 1);
+	for (AI_ARCHETYPE archetype: { AI_ARCHETYPE::GHOUL, AI_ARCHETYPE::SPITTER }) {
+		float default_ms = AI_THINK_INTERVAL_MS[(int) archetype];
+		float hz = think_rate_preset == 0 ? (default_ms > 0 ? 1000.f / default_ms : 0.f) : AI_DEBUG_THINK_RATES_HZ[think_rate_preset - 1];
+		set_think_rate(archetype, hz);
+		if (hz > 0)
+			printf("AI: %s think at %.0f Hz\n", archetype == AI_ARCHETYPE::GHOUL ? "ghouls" : "spitters", hz);
+		else
+			printf("AI: %s think every frame\n", archetype == AI_ARCHETYPE::GHOUL ? "ghouls" : "spitters");
+	}
+}
+
+void AISystem::step(float elapsed_ms, Entity player_hero, Entity boss)
+{
+	time_ms += elapsed_ms;
+	perception.begin_frame(&PhysicsSystem::spatial_index, player_hero);
+	step_firelings();
+	step_boulders();
+	step_ghouls(elapsed_ms);
+	step_spitters(elapsed_ms);
+	step_spitter_bullets(elapsed_ms);
+	step_tracers(elapsed_ms);
+	// the boss paces itself through its cooldowns and planner budget
+	if (registry.boss.has(boss))
+		boss_action_decision(player_hero, boss, renderer, elapsed_ms, perception);
+}
+
+void AISystem::schedule_thinkers(AI_ARCHETYPE archetype, uint count, float elapsed_ms)
+{
+	ThinkSchedule& schedule = schedules[(int) archetype];
+	thinks.assign(count, false);
+	if (count == 0)
+		return;
+
+	uint thinking = count;
+	if (schedule.interval_ms > 0) {
+		schedule.pending += count * elapsed_ms / schedule.interval_ms;
+		thinking = min((uint) schedule.pending, count);
+		schedule.pending -= thinking;
+	}
+	for (uint i = 0; i < thinking; i++)
+		thinks[(schedule.cursor + i) % count] = true;
+	schedule.cursor = (schedule.cursor + thinking) % count;
+}
+
+void AISystem::CurveBatch::resize(uint count)
+{
+	for (std::vector<float>* column: { &elapsed_s, &origin, &speed, &a, &b, &c, &x, &y, &slope })
+		column->resize(count);
+}
+
+template<typename T>
+void AISystem::gather(ComponentContainer<T>& container, bool with_animation)
+{
+	motions.resize(container.size());
+	animations.resize(container.size());
+	for (uint i = 0; i < container.size(); i++) {
+		Entity entity = container.entities[i];
+		motions[i] = &registry.motions.get(entity);
+		animations[i] = with_animation ? &registry.animated.get(entity) : nullptr;
+	}
+}
+
+// xorshift32, each fireling carries its own state so curves do not depend on update order
+static uint fireling_random(TestAI& testAI)
+{
+	uint x = testAI.rng_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	testAI.rng_state = x;
+	return x;
+}
+
+static float fireling_random_height(TestAI& testAI)
+{
+	return (float) (ENEMY_SPAWN_HEIGHT_IDLE_RANGE + fireling_random(testAI) % (window_height_px - ENEMY_SPAWN_HEIGHT_IDLE_RANGE * 2));
+}
+
+// Length of y = ax^2 + bx + c between x = 0 and the screen width
+static float fireling_curve_length(float a, float b)
+{
+	const float w = (float) window_width_px;
+	if (abs(a) < 1e-7f)
+		return w * sqrt(1 + b * b);
+	// with u = 2ax + b, the integral of sqrt(1 + u^2) is (u sqrt(1 + u^2) + asinh(u)) / 2
+	auto primitive = [](float u) { return (u * sqrt(1 + u * u) + asinh(u)) / 2; };
+	return abs((primitive(2 * a * w + b) - primitive(b)) / (2 * a));
+}
+
+// Starts a leg at start_ms from the edge the fireling departs from. The horizontal speed is
+// chosen so crossing takes as long as flying the whole curve at BASIC_SPEED
+static void start_fireling_leg(TestAI& testAI, float start_ms)
+{
+	testAI.start_ms = start_ms;
+	testAI.x_speed = window_width_px * BASIC_SPEED / fireling_curve_length(testAI.a, testAI.b);
+}
+
+// Picks the next curve once the fireling reaches the edge it was heading to, keeping the height it arrived at
+static void turn_fireling(TestAI& testAI)
+{
+	const float w = (float) window_width_px;
+	float squareFactor = fireling_random(testAI) % 2 == 0 ? 0.0005 : -0.0005;
+	if (testAI.departFromRight) {
+		// arrived on the left, c is the height there
+		float rightHeight = fireling_random_height(testAI);
+		testAI.b = (rightHeight - testAI.c - w * w * squareFactor) / w;
+	} else {
+		float rightHeight = testAI.a * w * w + testAI.b * w + testAI.c;
+		float leftHeight = fireling_random_height(testAI);
+		testAI.b = (rightHeight - leftHeight - w * w * squareFactor) / w;
+		testAI.c = leftHeight;
+	}
+	testAI.a = squareFactor;
+	testAI.departFromRight = !testAI.departFromRight;
+}
+
+void AISystem::step_firelings()
+{
+	const float w = (float) window_width_px;
+	auto &testAI_container = registry.testAIs;
+	auto &motion_container = registry.motions;
+	uint count = testAI_container.size();
+	motions.resize(count);
+	curves.resize(count);
+
+	// pass 1: resolve motions and make sure every fireling is on a leg that covers the current time
+	for (uint i = 0; i < count; i++)
+	{
+		Entity entity = testAI_container.entities[i];
+		TestAI &testAI = testAI_container.components[i];
+		if (testAI.motion_index >= motion_container.size() || (uint) motion_container.entities[testAI.motion_index] != (uint) entity)
+			testAI.motion_index = (uint) (&motion_container.get(entity) - motion_container.components.data());
+		Motion &motion = motion_container.components[testAI.motion_index];
+		motions[i] = &motion;
+
+		if (testAI.rng_state == 0)
+			testAI.rng_state = ((uint) entity * 2654435761u) ^ 0x9E3779B9u;
+		if (testAI.x_speed == 0.f) {
+			// first seen (spawned or loaded), continue from wherever it is on the curve
+			start_fireling_leg(testAI, 0.f);
+			float travelled = testAI.departFromRight ? w - motion.position.x : motion.position.x;
+			testAI.start_ms = time_ms - clamp(travelled, 0.f, w) / testAI.x_speed * 1000.f;
+		}
+		float leg_ms = w / testAI.x_speed * 1000.f;
+		while (time_ms - testAI.start_ms >= leg_ms) {
+			// the leg ended at an exact time, the next one starts there so no time is lost
+			float end_ms = testAI.start_ms + leg_ms;
+			turn_fireling(testAI);
+			start_fireling_leg(testAI, end_ms);
+			leg_ms = w / testAI.x_speed * 1000.f;
+		}
+
+		curves.elapsed_s[i] = (time_ms - testAI.start_ms) / 1000.f;
+		curves.origin[i] = testAI.departFromRight ? w : 0.f;
+		curves.speed[i] = testAI.departFromRight ? -testAI.x_speed : testAI.x_speed;
+		curves.a[i] = testAI.a;
+		curves.b[i] = testAI.b;
+		curves.c[i] = testAI.c;
+	}
+
+	// pass 2: positions straight from time, no branches so the loop vectorizes
+	for (uint i = 0; i < count; i++)
+	{
+		float x = curves.origin[i] + curves.speed[i] * curves.elapsed_s[i];
+		curves.x[i] = x;
+		curves.y[i] = (curves.a[i] * x + curves.b[i]) * x + curves.c[i];
+		curves.slope[i] = 2 * curves.a[i] * x + curves.b[i];
+	}
+
+	// pass 3: the velocity is the curve's derivative, physics only moves the fireling until the next frame snaps it back on
+	for (uint i = 0; i < count; i++)
+	{
+		Motion &motion = *motions[i];
+		motion.position = vec2(curves.x[i], curves.y[i]);
+		motion.velocity = vec2(curves.speed[i], curves.slope[i] * curves.speed[i]);
+		motion.dir = curves.speed[i] < 0 ? -1 : 1;
+	}
+}
+
+void AISystem::step_boulders()
+{
+	auto &boulder_container = registry.boulders;
+	gather(boulder_container, false);
+	for (uint i = 0; i < boulder_container.size(); i++) {
+		Motion& motion = *motions[i];
+		if (motion.velocity.x > 0) {
+			motion.angle += M_PI / 64;
+		} else if (motion.velocity.x < 0) {
+			motion.angle -= M_PI / 64;
+		}
+	}
+}
+
+void AISystem::step_ghouls(float elapsed_ms)
+{
+	const float GHOUL_SPEED = 100.f;
+	const float EDGE_DISTANCE = 0.f;
+	// ghouls closer than this on the same platform walk apart instead of bunching up
+	const float CROWD_RADIUS = 80.f;
+
+	auto &ghoul_container = registry.ghouls;
+	gather(ghoul_container, true);
+	schedule_thinkers(AI_ARCHETYPE::GHOUL, ghoul_container.size(), elapsed_ms);
+	for (uint i = 0; i < ghoul_container.size(); i++) {
+		Ghoul& enemy_reg = ghoul_container.components[i];
+		Motion& enemy_motion = *motions[i];
+		AnimationInfo& animation = *animations[i];
+		const SpatialGrid::Entry* ground = enemy_reg.left_x == -1.f && enemy_motion.velocity.y == 0.f ? perception.ground_below(enemy_motion.position, enemy_motion.scale) : nullptr;
+		if (ground) {
+			// landed, the platform it stands on bounds its patrol
+			animation.oneTimeState = 5;
+			animation.oneTimer = 0;
+			registry.colors.insert(ghoul_container.entities[i], {1, .8f, .8f});
+			enemy_reg.left_x = ground->min.x;
+			enemy_reg.right_x = ground->max.x;
+		}
+		else if (enemy_reg.left_x != -1.f && enemy_motion.velocity.x == 0.f && enemy_motion.velocity.y == 0.f && animation.oneTimeState == -1) {
+			// decision: walk away from the closest ghoul crowding this one, else to the side with more room
+			if (thinks[i]) {
+				float direction = max(enemy_motion.position.x - enemy_reg.left_x, enemy_reg.right_x - enemy_motion.position.x);
+				for (Entity other: perception.within_radius(enemy_motion.position, CROWD_RADIUS, SPATIAL_ENEMY)) {
+					if (other == ghoul_container.entities[i] || !registry.ghouls.has(other))
+						continue;
+					float other_x = registry.motions.get(other).position.x;
+					if (other_x != enemy_motion.position.x && other_x >= enemy_reg.left_x && other_x <= enemy_reg.right_x) {
+						direction = enemy_motion.position.x - other_x;
+						break;
+					}
+				}
+				direction = direction / abs(direction);
+				enemy_motion.velocity.x = direction * GHOUL_SPEED;
+				enemy_motion.dir = (int)direction;
+			}
+		}
+			// Reverse direction
+		else if (enemy_motion.position.x - enemy_reg.left_x <= EDGE_DISTANCE && enemy_motion.velocity.y == 0.f && enemy_motion.velocity.x != 0.f) {
+			enemy_motion.velocity.x = GHOUL_SPEED;
+			enemy_motion.dir = 1;
+		}
+		else if (enemy_reg.right_x - enemy_motion.position.x <= EDGE_DISTANCE && enemy_motion.velocity.y == 0.f && enemy_motion.velocity.x != 0.f) {
+			enemy_motion.velocity.x = -1.f * GHOUL_SPEED;
+			enemy_motion.dir = -1;
+		}
+	}
+}
+
+void AISystem::step_spitters(float elapsed_ms)
+{
+	const uint SHOOT_STATE = 2;
+	const uint SPITTER_FIRE_FRAME = 4;
+	const float WALKING_SPEED = 100.f;
+	const float EDGE_DISTANCE = 10.f;
+	const float STOP_WALK_TIME = 300.f;
+	// a spitter with another one this close walks away from it rather than in a random direction
+	const float CROWD_RADIUS = 120.f;
+
+	auto &spitterEnemy_container = registry.spitterEnemies;
+	gather(spitterEnemy_container, true);
+	schedule_thinkers(AI_ARCHETYPE::SPITTER, spitterEnemy_container.size(), elapsed_ms);
+	shooters.clear();
+	for (uint i = 0; i < spitterEnemy_container.size(); i++)
+	{
+		SpitterEnemy &spitterEnemy = spitterEnemy_container.components[i];
+		spitterEnemy.timeUntilNextShotMs -= elapsed_ms;
+		Entity entity = spitterEnemy_container.entities[i];
+		Motion &motion = *motions[i];
+		AnimationInfo &animation = *animations[i];
+
+		const SpatialGrid::Entry* ground = spitterEnemy.left_x == -1.f && motion.velocity.y == 0.f ? perception.ground_below(motion.position, motion.scale) : nullptr;
+		if (ground) {
+			// landed, patrol the platform but stay clear of the walls
+			animation.oneTimeState = 3;
+			animation.oneTimer = 0;
+			spitterEnemy.left_x = max(ground->min.x, 70.f);
+			spitterEnemy.right_x = min(ground->max.x, 1125.f);
+		}
+
+		if (!spitterEnemy.canShoot && spitterEnemy.timeUntilNextShotMs > STOP_WALK_TIME && motion.velocity.y == 0.f && animation.oneTimeState != 2) {
+			if (spitterEnemy.left_x != -1.f && motion.velocity.x == 0.f) {
+				// decision: start walking, away from the edge, from a spitter next to it or in a random direction
+				if (thinks[i]) {
+					float direction;
+					if (motion.position.x <= spitterEnemy.left_x || motion.position.x >= spitterEnemy.right_x) {
+						direction = max(motion.position.x - spitterEnemy.left_x, spitterEnemy.right_x - motion.position.x);
+					}
+					else {
+						direction = (rand() % 2) - 0.5f;
+						// the closest enemy is this spitter itself, the other one may be a neighbour
+						for (Entity other: perception.nearest(motion.position, 2, SPATIAL_ENEMY)) {
+							if (other == entity || !registry.spitterEnemies.has(other))
+								continue;
+							vec2 other_pos = registry.motions.get(other).position;
+							if (other_pos.x != motion.position.x && length(other_pos - motion.position) <= CROWD_RADIUS)
+								direction = motion.position.x - other_pos.x;
+						}
+					}
+
+					direction = direction / abs(direction);
+					motion.velocity.x = direction * WALKING_SPEED;
+					motion.dir = (int)direction;
+				}
+			}
+				// Reverse direction
+			else if (motion.position.x - spitterEnemy.left_x <= EDGE_DISTANCE && motion.velocity.x != 0.f) {
+				motion.velocity.x = WALKING_SPEED;
+				motion.dir = 1;
+			}
+			else if (spitterEnemy.right_x - motion.position.x <= EDGE_DISTANCE && motion.velocity.x != 0.f) {
+				motion.velocity.x = -1.f * WALKING_SPEED;
+				motion.dir = -1;
+			}
+		}
+		else if (spitterEnemy.canShoot || spitterEnemy.timeUntilNextShotMs <= STOP_WALK_TIME) {
+			motion.velocity.x = 0;
+		}
+
+		animation.curState = (motion.velocity.x != 0)? 1: 0;
+
+		// the bullet has to leave on the fire frame, so this is checked every frame
+		if (animation.oneTimeState == SHOOT_STATE && (int)floor(animation.oneTimer * ANIMATION_SPEED_FACTOR) == SPITTER_FIRE_FRAME && spitterEnemy.canShoot) {
+			shooters.push_back(entity);
+			spitterEnemy.canShoot = false;
+		}
+		// decision: start the attack
+		if (thinks[i] && spitterEnemy.timeUntilNextShotMs <= 0.f && registry.enemies.get(entity).hitting == true)
+		{
+			// attack animation
+			animation.oneTimeState = SHOOT_STATE;
+			animation.oneTimer = 0;
+			spitterEnemy.canShoot = true;
+			spitterEnemy.timeUntilNextShotMs = spitter_projectile_delay_ms;
+		}
+	}
+
+	// bullets are created after the batch, creating motions would invalidate the gathered pointers
+	for (Entity entity: shooters) {
+		Motion& motion = registry.motions.get(entity);
+		Entity spitterBullet = createSpitterEnemyBullet(renderer, motion.position, motion.angle);
+		Motion& spitter_motion = registry.motions.get(entity);
+		float absolute_scale_x = abs(spitter_motion.scale[0]);
+		if (registry.motions.get(spitterBullet).velocity[0] < 0.0f)
+			spitter_motion.scale[0] = -absolute_scale_x;
+		else
+			spitter_motion.scale[0] = absolute_scale_x;
+	}
+}
+
+void AISystem::step_spitter_bullets(float elapsed_ms)
+{
+	// make bullets smaller over time, iterating backwards since decayed ones are removed
+	auto& spitterBullets_container = registry.spitterBullets;
+	for (int i = (int) spitterBullets_container.size() - 1; i >= 0; i--)
+	{
+		SpitterBullet& spitterBullet = spitterBullets_container.components[i];
+		Entity entity = spitterBullets_container.entities[i];
+		RenderRequest& render = registry.renderRequests.get(entity);
+		Motion& motion = registry.motions.get(entity);
+		motion.scale = vec2(motion.scale.x / spitterBullet.mass, motion.scale.y / spitterBullet.mass);
+		spitterBullet.mass -= elapsed_ms / SPITTER_PROJECTILE_REDUCTION_FACTOR;
+		motion.scale = vec2(motion.scale.x * spitterBullet.mass, motion.scale.y * spitterBullet.mass);
+		render.scale = motion.scale;
+		if (spitterBullet.mass <= SPITTER_PROJECTILE_MIN_SIZE)
+		{
+			spitterBullet.mass = 0;
+			registry.remove_all_components_of(entity);
+		}
+	}
+}
+
+void AISystem::step_tracers(float elapsed_ms)
+{
+	const uint PHASE_IN_STATE = 1;
+	const uint PHASE_OUT_STATE = 4;
+
+	auto &tracer_container = registry.followingEnemies;
+	gather(tracer_container, true);
+	vec2 hero_position = perception.player_position();
+	for (uint i = 0; i < tracer_container.size(); i++) {
+		Entity enemy = tracer_container.entities[i];
+		FollowingEnemies& enemy_reg = tracer_container.components[i];
+		Motion& enemy_motion = *motions[i];
+		AnimationInfo& animation = *animations[i];
+
+		enemy_reg.next_blink_time -= elapsed_ms;
+		if (enemy_reg.next_blink_time < 0.f && enemy_reg.blinked == false)
+		{
+			//Time between blinks
+			enemy_reg.next_blink_time = 700.f;
+
+			if (enemy_reg.path.size() == 0 && find_map_index(enemy_motion.position) != find_map_index(hero_position)) {
+				std::vector<std::vector<char>> vec = grid_vec;
+				bfs_follow_start(vec, enemy_motion.position, hero_position, enemy);
+			}
+
+			//Don't blink when not moving: next pos in path is same pos as current
+			if (enemy_reg.path.size() != 0 && find_index_from_map(enemy_reg.path.back()) == enemy_motion.position) {
+				enemy_reg.path.pop_back();
+			}
+			else if (enemy_reg.path.size() != 0)
+			{
+				animation.oneTimeState = PHASE_IN_STATE;
+				animation.oneTimer = 0;
+				vec2 converted_pos = find_index_from_map(enemy_reg.path.back());
+				enemy_motion.dir = (converted_pos.x > enemy_motion.position.x) ? -1 : 1;
+				enemy_motion.position = converted_pos;
+				enemy_reg.path.pop_back();
+
+				//Don't blink when not moving: next loop will be to re-calc the path
+				if (enemy_reg.path.size() != 0) {
+					enemy_reg.blinked = true;
+				}
+			}
+		}
+
+		if (enemy_reg.next_blink_time < 0.0f && enemy_reg.blinked == true) {
+			enemy_reg.next_blink_time = 100.f;
+			animation.oneTimeState = PHASE_OUT_STATE;
+			animation.oneTimer = 0;
+			enemy_reg.blinked = false;
+		}
+	}
 }
 
 void point_checker(vec2& point, float x_stop, float y_stop) {
@@ -4,14 +4,93 @@
 
 #include "tiny_ecs_registry.hpp"
 #include "common.hpp"
+#include "perception.hpp"
+
+class RenderSystem;
+
+// Enemy kinds the AI system updates as one batch each
+enum class AI_ARCHETYPE {
+	FIRELING = 0,
+	BOULDER = FIRELING + 1,
+	GHOUL = BOULDER + 1,
+	SPITTER = GHOUL + 1,
+	TRACER = SPITTER + 1,
+	ARCHETYPE_COUNT = TRACER + 1
+};
+
+// Default time between two decisions of the same agent, 0 means every frame.
+// Only decision logic is throttled, motion and animation sync still run every frame.
+const float AI_THINK_INTERVAL_MS[(int) AI_ARCHETYPE::ARCHETYPE_COUNT] = {
+	0.f,	// FIRELING
+	0.f,	// BOULDER
+	0.f,	// GHOUL
+	100.f,	// SPITTER, 10 Hz
+	0.f,	// TRACER, already paced by its blink timer
+};
+// Rates the debug key sets the ghouls and spitters to in turn after their defaults, 0 means every frame
+const float AI_DEBUG_THINK_RATES_HZ[] = { 0.f, 30.f, 10.f, 2.f };
+const uint AI_DEBUG_THINK_RATE_COUNT = sizeof(AI_DEBUG_THINK_RATES_HZ) / sizeof(float);
 
 class AISystem
 {
 
 public:
-	void step(float elapsed_ms);
+	void init(RenderSystem* renderer);
+	void step(float elapsed_ms, Entity player_hero, Entity boss);
+
+	// Changes how often an archetype thinks, 0 to think every frame
+	void set_think_rate(AI_ARCHETYPE archetype, float hz);
+	// Moves the ghouls and spitters, the archetypes whose decisions are throttled, to the next
+	// rate of AI_DEBUG_THINK_RATES_HZ, or back to their defaults after the last one
+	void cycle_think_rates();
+
+	AISystem();
+
+private:
+	// Agents of an archetype think round robin, a slice of them per frame, so over one interval
+	// every agent thinks once and the cost is spread evenly instead of spiking
+	struct ThinkSchedule
+	{
+		float interval_ms;
+		float pending;
+		uint cursor;
+	};
+	// Marks which of the count agents think this frame in the thinks scratch array
+	void schedule_thinkers(AI_ARCHETYPE archetype, uint count, float elapsed_ms);
+
+	// Fireling curves as plain arrays, so they can be evaluated in one tight loop
+	struct CurveBatch
+	{
+		std::vector<float> elapsed_s, origin, speed, a, b, c;
+		std::vector<float> x, y, slope;
+		void resize(uint count);
+	};
+
+	void step_firelings();
+	void step_boulders();
+	void step_ghouls(float elapsed_ms);
+	void step_spitters(float elapsed_ms);
+	void step_spitter_bullets(float elapsed_ms);
+	void step_tracers(float elapsed_ms);
+
+	// Looks up the motion and animation of every agent in the container once, before the batch runs
+	template<typename T>
+	void gather(ComponentContainer<T>& container, bool with_animation);
+
+	RenderSystem* renderer = nullptr;
+	Perception perception;
+	// time the AI has been running, firelings are placed on their curves from it
+	float time_ms = 0.f;
+	ThinkSchedule schedules[(int) AI_ARCHETYPE::ARCHETYPE_COUNT];
+	// 0 for the defaults, otherwise one past the index into AI_DEBUG_THINK_RATES_HZ
+	uint think_rate_preset = 0;
 
-	AISystem() {}
+	// scratch arrays reused by every batch
+	std::vector<Motion*> motions;
+	std::vector<AnimationInfo*> animations;
+	std::vector<bool> thinks;
+	std::vector<Entity> shooters;
+	CurveBatch curves;
 };
 
 vec2 find_map_index(vec2 pos);
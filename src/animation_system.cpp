@@ -0,0 +1,44 @@
+// internal
+#include "animation_system.hpp"
+#include "world_system.hpp"
+
+void AnimationSystem::step(float elapsed_ms, bool advance_one_time)
+{
+	time_s += elapsed_ms / 1000.f;
+
+	auto &animated = registry.animated;
+	for (uint i = 0; i < animated.size(); i++) {
+		AnimationInfo &info = animated.components[i];
+		if (info.oneTimeState == -1)
+			continue;
+		// dying entities hold the cell they last showed
+		if (!registry.deathTimers.has(animated.entities[i]) &&
+			(int)floor(info.oneTimer * ANIMATION_SPEED_FACTOR) >= info.stateFrameLength[info.oneTimeState]) {
+			info.oneTimeState = -1;
+			info.oneTimer = 0;
+		} else if (advance_one_time) {
+			info.oneTimer += elapsed_ms / 1000.f;
+		}
+	}
+}
+
+void AnimationSystem::resolve()
+{
+	const int loop_count = (int)floor(time_s * ANIMATION_SPEED_FACTOR);
+	auto &animated = registry.animated;
+	for (uint i = 0; i < animated.size(); i++) {
+		AnimationInfo &info = animated.components[i];
+		if (registry.deathTimers.has(animated.entities[i]))
+			continue;
+		if (info.oneTimeState != -1) {
+			// a one time animation that ran through keeps its last shown cell until step ends it
+			int count = (int)floor(info.oneTimer * ANIMATION_SPEED_FACTOR);
+			if (count < info.stateFrameLength[info.oneTimeState])
+				info.shown_frame = vec2(count, info.oneTimeState);
+		} else {
+			info.shown_frame = vec2(loop_count % info.stateFrameLength[info.curState], info.curState);
+		}
+		const vec2 cell_size = vec2(1.f / info.stateCycleLength, 1.f / info.states);
+		info.frame_rect = vec4(info.shown_frame * cell_size, cell_size);
+	}
+}
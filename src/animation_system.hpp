@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// Advances every sprite sheet animation once per tick and resolves the cell each one shows, so the
+// renderer only reads AnimationInfo::frame_rect. Nothing runs while the game is paused.
+class AnimationSystem
+{
+public:
+	// Ends the one time animations that ran through last tick, then advances the clocks. Runs before
+	// the world step, which reacts to a one time animation reaching its last frame
+	void step(float elapsed_ms, bool advance_one_time);
+	// Picks the cell every animation shows, after the world step and collisions changed states
+	void resolve();
+
+private:
+	// drives the looping states
+	double time_s = 0;
+};
@@ -0,0 +1,168 @@
+// internal
+#include "asset_archive.hpp"
+
+// stlib
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive::~AssetArchive()
+{
+	close();
+}
+
+bool AssetArchive::open(const std::string &path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER file_size;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+	file_handle = file;
+	mapping_handle = mapping;
+	size = (size_t)file_size.QuadPart;
+	base = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	struct stat file_stat;
+	if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+		size = (size_t)file_stat.st_size;
+		void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping != MAP_FAILED)
+			base = (const unsigned char *)mapping;
+	}
+	// the mapping stays valid without the descriptor
+	::close(file);
+#endif
+	if (!base) {
+		close();
+		return false;
+	}
+
+	const AssetArchiveHeader *header = (const AssetArchiveHeader *)base;
+	if (size < sizeof(AssetArchiveHeader) || header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION ||
+		size < sizeof(AssetArchiveHeader) + (size_t)header->entry_count * sizeof(AssetEntry)) {
+		fprintf(stderr, "%s is not a valid asset archive, repack it\n", path.c_str());
+		close();
+		return false;
+	}
+	entries = (const AssetEntry *)(base + sizeof(AssetArchiveHeader));
+	entry_count = header->entry_count;
+	for (uint i = 0; i < entry_count; i++) {
+		if (entries[i].offset + entries[i].size > size) {
+			fprintf(stderr, "%s is truncated, repack it\n", path.c_str());
+			close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void AssetArchive::close()
+{
+#ifdef _WIN32
+	if (base)
+		UnmapViewOfFile(base);
+	if (mapping_handle)
+		CloseHandle(mapping_handle);
+	if (file_handle)
+		CloseHandle(file_handle);
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+#else
+	if (base)
+		munmap((void *)base, size);
+#endif
+	base = nullptr;
+	size = 0;
+	entries = nullptr;
+	entry_count = 0;
+}
+
+const AssetEntry *AssetArchive::find(const std::string &name) const
+{
+	// binary search, entries are sorted by name
+	uint lo = 0;
+	uint hi = entry_count;
+	while (lo < hi) {
+		uint mid = (lo + hi) / 2;
+		int order = strncmp(entries[mid].name, name.c_str(), ASSET_NAME_LENGTH);
+		if (order == 0) {
+			// a loose file that differs from what was packed wins, shipped builds have no loose files
+			const AssetEntry &entry = entries[mid];
+			uint64_t source_size;
+			int64_t source_mtime;
+			if (asset_file_stamp(data_path() + "/" + name, source_size, source_mtime) &&
+				(source_size != entry.source_size || source_mtime != entry.source_mtime)) {
+				fprintf(stderr, "%s changed since it was packed, loading the file instead (run pack_assets)\n", name.c_str());
+				return nullptr;
+			}
+			return &entry;
+		}
+		if (order < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return nullptr;
+}
+
+const AssetArchive &asset_archive()
+{
+	static AssetArchive archive;
+	static bool opened = false;
+	if (!opened) {
+		opened = true;
+		const std::string path = data_path() + "/assets.ttpack";
+		if (archive.open(path))
+			printf("Loading assets from %s\n", path.c_str());
+		else
+			printf("No asset archive at %s, loading the asset files\n", path.c_str());
+	}
+	return archive;
+}
+
+std::string asset_name(const std::string &path)
+{
+	const std::string prefix = data_path() + "/";
+	if (path.compare(0, prefix.size(), prefix) == 0)
+		return path.substr(prefix.size());
+	return path;
+}
+
+bool asset_file_stamp(const std::string &path, uint64_t &size, int64_t &mtime)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+		return false;
+	size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	mtime = (int64_t)(((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime);
+#else
+	struct stat file_stat;
+	if (stat(path.c_str(), &file_stat) != 0)
+		return false;
+	size = (uint64_t)file_stat.st_size;
+	mtime = (int64_t)file_stat.st_mtime;
+#endif
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <cstdint>
+#include <string>
+
+// Written by tools/titans_pack.cpp (the pack_assets target) to data/assets.ttpack.
+// Layout: header, entries sorted by name, then the entry data, each aligned to ASSET_ALIGNMENT
+const uint32_t ASSET_ARCHIVE_MAGIC = 0x4B505454; // "TTPK"
+const uint32_t ASSET_ARCHIVE_VERSION = 2;
+const uint ASSET_NAME_LENGTH = 64;
+const uint ASSET_ALIGNMENT = 16;
+// Sound effects are baked to PCM in the format the mixer is opened with (signed 16 bit, native order)
+const int ASSET_AUDIO_FREQUENCY = 44100;
+const int ASSET_AUDIO_CHANNELS = 2;
+
+enum class ASSET_TYPE : uint32_t {
+	// RGBA8 pixels, width by height
+	TEXTURE = 0,
+	// interleaved PCM samples
+	SOUND = TEXTURE + 1,
+	// vec2 original size, then width ColoredVertex and height int32 index pairs
+	COLLISION_MESH = SOUND + 1
+};
+
+struct AssetArchiveHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t reserved;
+};
+
+struct AssetEntry
+{
+	// path relative to the data directory, e.g. "textures/hero.png"
+	char name[ASSET_NAME_LENGTH];
+	ASSET_TYPE type;
+	uint32_t width;
+	uint32_t height;
+	uint32_t reserved;
+	// from the start of the archive, in bytes
+	uint64_t offset;
+	uint64_t size;
+	// the source file when it was packed, see asset_file_stamp
+	uint64_t source_size;
+	int64_t source_mtime;
+};
+
+// Read only memory mapping of an archive, entry data is used in place
+class AssetArchive
+{
+public:
+	~AssetArchive();
+
+	// false if the file is missing or not a valid archive of this version
+	bool open(const std::string &path);
+	bool is_open() const { return base != nullptr; }
+
+	// nullptr if the asset is not in the archive, or if its file in the data directory has changed
+	// since it was packed, so edited assets show up without repacking
+	const AssetEntry *find(const std::string &name) const;
+	const unsigned char *data(const AssetEntry &entry) const { return base + entry.offset; }
+
+private:
+	void close();
+
+	const unsigned char *base = nullptr;
+	size_t size = 0;
+	const AssetEntry *entries = nullptr;
+	uint entry_count = 0;
+#ifdef _WIN32
+	void *file_handle = nullptr;
+	void *mapping_handle = nullptr;
+#endif
+};
+
+// The game's archive, opened on first use. Assets it does not have are loaded from their own files,
+// which is also what happens during development when no archive has been packed
+const AssetArchive &asset_archive();
+
+// Name of an asset file in the archive, its path relative to the data directory
+std::string asset_name(const std::string &path);
+
+// Size and last modification time of a file, false if it does not exist
+bool asset_file_stamp(const std::string &path, uint64_t &size, int64_t &mtime);
@@ -0,0 +1,87 @@
+// internal
+#include "asset_loader.hpp"
+
+// stlib
+#include <algorithm>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static float ms_since(Clock::time_point start)
+{
+	return (float)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.f;
+}
+
+AssetLoader::AssetLoader(uint thread_count)
+{
+	if (thread_count == 0)
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	for (uint i = 0; i < thread_count; i++)
+		workers.emplace_back(&AssetLoader::work, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	job_ready.notify_all();
+	for (std::thread &worker : workers)
+		worker.join();
+}
+
+void AssetLoader::submit(std::string name, std::function<void()> decode, std::function<void()> finish)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (submitted == 0)
+			batch_start = Clock::now();
+		pending.push_back({ std::move(name), std::move(decode), std::move(finish), 0.f });
+		submitted++;
+	}
+	job_ready.notify_one();
+}
+
+void AssetLoader::work()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		job_ready.wait(lock, [this] { return stopping || !pending.empty(); });
+		if (pending.empty())
+			return;
+		Job job = std::move(pending.front());
+		pending.pop_front();
+		lock.unlock();
+
+		Clock::time_point start = Clock::now();
+		job.decode();
+		job.decode_ms = ms_since(start);
+
+		lock.lock();
+		decoded.push_back(std::move(job));
+		job_done.notify_one();
+	}
+}
+
+void AssetLoader::wait_all()
+{
+	uint count = submitted;
+	float decode_total_ms = 0.f;
+	for (uint finished = 0; finished < count; finished++) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			job_done.wait(lock, [this] { return !decoded.empty(); });
+			job = std::move(decoded.front());
+			decoded.pop_front();
+		}
+
+		Clock::time_point finish_start = Clock::now();
+		if (job.finish)
+			job.finish();
+		printf("Loaded %s: %.2f ms decoding, %.2f ms finishing\n", job.name.c_str(), job.decode_ms, ms_since(finish_start));
+		decode_total_ms += job.decode_ms;
+	}
+	submitted -= count;
+	printf("Loaded %u assets in %.2f ms on %zu threads (%.2f ms of decoding)\n", count, ms_since(batch_start), workers.size(), decode_total_ms);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Decodes assets on a pool of worker threads. Anything touching GL (or other main thread only state)
+// goes in the finish step, which wait_all runs on the calling thread as each decode completes.
+class AssetLoader
+{
+public:
+	// 0 threads picks one per core
+	explicit AssetLoader(uint thread_count = 0);
+	~AssetLoader();
+
+	// name is only used when reporting load times
+	void submit(std::string name, std::function<void()> decode, std::function<void()> finish = nullptr);
+	// Runs the finish step of every submitted asset, in completion order, and returns once all are done
+	void wait_all();
+
+private:
+	struct Job
+	{
+		std::string name;
+		std::function<void()> decode;
+		std::function<void()> finish;
+		float decode_ms;
+	};
+
+	void work();
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable job_ready;
+	std::condition_variable job_done;
+	std::deque<Job> pending;
+	std::deque<Job> decoded;
+	uint submitted = 0;
+	// when the first asset of the current batch was submitted
+	std::chrono::high_resolution_clock::time_point batch_start;
+	bool stopping = false;
+};
@@ -0,0 +1,457 @@
+// internal
+#include "boss_planner.hpp"
+#include "world_init.hpp"
+#include "world_system.hpp"
+
+// stlib
+#include <chrono>
+#include <cstring>
+
+// Where the boss lands when teleporting to the given cell, same as getRandomWalkablePos without randomness
+static vec2 boss_cell_position(uint cell) {
+    vec3 area = walkable_area.at(BOSS_PLAN_PLATFORMS[cell]);
+    return {area.x, area.y - ASSET_SIZE.at(TEXTURE_ASSET_ID::BOSS).y / 2.f};
+}
+
+static uint8_t clamp_count(uint count) {
+    return (uint8_t) min(count, 255u);
+}
+
+// FNV-1a over the raw bytes of the state
+static uint32_t hash_state(const BossPlanState& state) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(BossPlanState); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+BossPlanState make_boss_plan_state(Entity boss) {
+    BossPlanState state;
+    memset(&state, 0, sizeof(state));
+
+    vec2 boss_pos = registry.motions.get(boss).position;
+    state.boss_cell = BOSS_PLAN_CELL_OFFGRID;
+    for (uint cell = 0; cell < BOSS_PLAN_PLATFORM_COUNT; cell++) {
+        if (boss_cell_position(cell) == boss_pos)
+            state.boss_cell = cell;
+    }
+    state.num_ghouls = clamp_count(registry.ghouls.size());
+    state.num_spitters = clamp_count(registry.spitterEnemies.size());
+
+    // cooldowns as they will be at the next decision, when the global cooldown runs out
+    Boss& boss_state = registry.boss.get(boss);
+    float until_decision = max(boss_state.cooldowns[(uint) BOSS_STATE::SIZE], 0.f);
+    for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++)
+        state.cooldowns[i] = max(boss_state.cooldowns[i] - until_decision, 0.f);
+    return state;
+}
+
+BossPlanContext make_boss_plan_context(Entity player_hero, Entity boss, Perception& perception) {
+    BossPlanContext context;
+    memset(&context, 0, sizeof(context));
+
+    Player& player = registry.players.get(player_hero);
+    context.player_has_sword = player.hasWeapon && registry.swords.has(player.weapon);
+
+    vec2 player_pos = registry.motions.get(player_hero).position;
+    Motion& boss_motion = registry.motions.get(boss);
+    for (uint cell = 0; cell < BOSS_PLAN_CELL_COUNT; cell++) {
+        vec2 boss_pos = cell == BOSS_PLAN_CELL_OFFGRID ? boss_motion.position : boss_cell_position(cell);
+
+        float x_buffer = max(abs(boss_pos.x - player_pos.x) - boss_motion.scale.x / 2, 0.f);
+        float y_buffer = max(abs(boss_pos.y - player_pos.y) - boss_motion.scale.y / 2, 0.f);
+        context.player_dist[cell] = sqrt(dot(vec2(x_buffer, y_buffer), vec2(x_buffer, y_buffer)));
+
+        vec2 pos_dif = {abs(boss_pos.x - player_pos.x), abs(boss_pos.y - player_pos.y)};
+        float x_penalty = std::pow(std::pow(MDP_BASE_REWARD, 1.f/20.f), min(pos_dif.x, 300.f) - 280);
+        float y_penalty = std::pow(std::pow(MDP_BASE_REWARD, 1.f/20.f), min(pos_dif.y, 60.f) - 40);
+        context.swipe_reward[cell] = MDP_BASE_REWARD - x_penalty - y_penalty;
+
+        // bullets are only worth it with a clear line to the player
+        context.bullet_reward[cell] = perception.line_of_sight(boss_pos, player_pos) ? MDP_BASE_REWARD / 2.5f : MDP_BASE_REWARD / 1000.f;
+    }
+    return context;
+}
+
+static float summon_ghouls_reward(uint num_ghouls_old, uint num_ghouls) {
+    return MDP_BASE_REWARD / 7.f * (num_ghouls - num_ghouls_old) * (1 - min(std::pow(2, num_ghouls_old / (float) BOSS_MAX_GHOULS) - 1, (double) 1));
+}
+
+static float summon_spitters_reward(uint num_spitters_old, uint num_spitters) {
+    return MDP_BASE_REWARD / 4.f * (num_spitters - num_spitters_old) * (1 - min(std::pow(2, num_spitters_old / (float) BOSS_MAX_SPITTERS) - 1, (double) 1));
+}
+
+static float teleport_reward(const BossPlanContext& context, uint cell_old, uint cell) {
+    float player_dist_old = context.player_dist[cell_old];
+    float player_dist = context.player_dist[cell];
+    if (context.player_has_sword) {
+        // a sword wielding player is a threat, so getting away is what counts
+        if (player_dist_old < 150)
+            return MDP_BASE_REWARD * 1000;
+        return MDP_BASE_REWARD * (1 - min(std::pow(2, player_dist_old / 300.f) - 1, (double) 1)) * max(min((player_dist - player_dist_old) / 100.f, 1.f), -1.f);
+    }
+    return MDP_BASE_REWARD * (1 - min(std::pow(2, player_dist / 300.f) - 1, (double) 1)) * max(min((player_dist_old - player_dist) / 100.f, 1.f), -1.f);
+}
+
+uint plan_outcome_count(BOSS_STATE action, const BossPlanState& state) {
+    switch (action) {
+        case BOSS_STATE::TELEPORT:
+            return state.boss_cell == BOSS_PLAN_CELL_OFFGRID ? BOSS_PLAN_PLATFORM_COUNT : BOSS_PLAN_PLATFORM_COUNT - 1;
+        case BOSS_STATE::SUMMON_GHOULS:
+            return 5;
+        case BOSS_STATE::SUMMON_SPITTERS:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+float plan_transition(const BossPlanContext& context, BOSS_STATE action, const BossPlanState& state, uint outcome, BossPlanState& next) {
+    next = state;
+    next.depth++;
+    next.cooldowns[(uint) action] = BOSS_ACTION_COOLDOWNS[(uint) action];
+    for (float& cd: next.cooldowns)
+        if (cd > 0)
+            cd = max(cd - BOSS_ACTION_COOLDOWNS[(uint) BOSS_STATE::SIZE], 0.f);
+
+    switch (action) {
+        case BOSS_STATE::TELEPORT: {
+            // outcomes enumerate the platforms other than the current one
+            uint cell = outcome;
+            if (state.boss_cell != BOSS_PLAN_CELL_OFFGRID && cell >= state.boss_cell)
+                cell++;
+            next.boss_cell = cell;
+            return teleport_reward(context, state.boss_cell, cell);
+        } case BOSS_STATE::SWIPE:
+            return context.swipe_reward[state.boss_cell];
+        case BOSS_STATE::SUMMON_GHOULS:
+            next.num_ghouls = clamp_count(state.num_ghouls + 3 + outcome);
+            return summon_ghouls_reward(state.num_ghouls, state.num_ghouls + 3 + outcome);
+        case BOSS_STATE::SUMMON_SPITTERS:
+            next.num_spitters = clamp_count(state.num_spitters + 1 + outcome);
+            return summon_spitters_reward(state.num_spitters, state.num_spitters + 1 + outcome);
+        case BOSS_STATE::SUMMON_BULLETS:
+            return context.bullet_reward[state.boss_cell];
+        case BOSS_STATE::SIZE:
+            break;
+    }
+    return 0;
+}
+
+BOSS_STATE BossPlanner::decide(const BossPlanState& root, const BossPlanContext& context) {
+    this->context = &context;
+    if (++generation == 0) {
+        memset(table, 0, sizeof(table));
+        generation = 1;
+    }
+    last_expansions = 0;
+    last_table_hits = 0;
+
+    BOSS_STATE action = BOSS_STATE::SIZE;
+    float max_utility = 0;
+    for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++) {
+        if (root.cooldowns[i] <= 0) {
+            float utility = action_value((BOSS_STATE) i, root);
+            if (utility > max_utility) {
+                max_utility = utility;
+                action = (BOSS_STATE) i;
+            }
+        }
+    }
+
+    decisions++;
+    total_expansions += last_expansions;
+    this->context = nullptr;
+    return action;
+}
+
+float BossPlanner::state_value(const BossPlanState& state) {
+    if (state.depth > MDP_HORIZON)
+        return 0;
+
+    uint32_t hash = hash_state(state);
+    TableEntry* slot = nullptr;
+    for (uint probe = 0; probe < 8; probe++) {
+        TableEntry& entry = table[(hash + probe) & (BOSS_PLAN_TABLE_SIZE - 1)];
+        if (entry.generation != generation) {
+            slot = &entry;
+            break;
+        }
+        if (memcmp(&entry.state, &state, sizeof(BossPlanState)) == 0) {
+            last_table_hits++;
+            return entry.value;
+        }
+    }
+    // probe chain is full, evict the home slot
+    if (slot == nullptr)
+        slot = &table[hash & (BOSS_PLAN_TABLE_SIZE - 1)];
+
+    last_expansions++;
+    float max_utility = 0;
+    for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++) {
+        if (state.cooldowns[i] <= 0) {
+            float utility = action_value((BOSS_STATE) i, state);
+            if (utility > max_utility)
+                max_utility = utility;
+        }
+    }
+
+    // the recursion above may have reused the slot, so fill it in only now
+    slot->state = state;
+    slot->value = max_utility;
+    slot->generation = generation;
+    return max_utility;
+}
+
+float BossPlanner::action_value(BOSS_STATE action, const BossPlanState& state) {
+    // outcomes are equally likely, the same weighting MCTS samples them with
+    uint outcomes = plan_outcome_count(action, state);
+    float weight = 1.f / outcomes;
+    float reward = 0;
+    for (uint outcome = 0; outcome < outcomes; outcome++) {
+        BossPlanState next;
+        float immediate = plan_transition(*context, action, state, outcome, next);
+        reward += (immediate + MDP_DISCOUNT_FACTOR * state_value(next)) * weight;
+    }
+    return reward;
+}
+
+MctsBossPlanner::MctsBossPlanner() {
+    // the pools never grow past their capacity, so the search itself does not allocate
+    nodes.reserve(MCTS_NODE_CAPACITY);
+    spare.reserve(MCTS_NODE_CAPACITY);
+}
+
+void MctsBossPlanner::reset() {
+    nodes.clear();
+    root = -1;
+    committed = -1;
+}
+
+uint32_t MctsBossPlanner::next_random() {
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+int MctsBossPlanner::new_node(const BossPlanState& state, int parent, uint8_t action) {
+    if (nodes.size() >= MCTS_NODE_CAPACITY)
+        return -1;
+    Node node;
+    node.state = state;
+    node.parent = parent;
+    for (int& child: node.children)
+        child = -1;
+    node.action = action;
+    node.expanded = false;
+    node.visits = 0;
+    node.value_sum = 0;
+    nodes.push_back(node);
+    return (int) nodes.size() - 1;
+}
+
+// Two states are the same decision point if the boss is in the same place, the minion counts
+// agree and the same actions are ready. Cooldown values drift every frame so they are not compared.
+static bool same_decision_point(const BossPlanState& a, const BossPlanState& b) {
+    if (a.boss_cell != b.boss_cell || a.num_ghouls != b.num_ghouls || a.num_spitters != b.num_spitters)
+        return false;
+    for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++)
+        if ((a.cooldowns[i] <= 0) != (b.cooldowns[i] <= 0))
+            return false;
+    return true;
+}
+
+void MctsBossPlanner::set_root(const BossPlanState& observed) {
+    if (root != -1 && same_decision_point(nodes[root].state, observed))
+        return;
+
+    // see whether the committed action ended up in an outcome we already searched
+    if (committed != -1) {
+        for (int child: nodes[committed].children) {
+            // depth only grows while the tree is reused, start over before it wraps
+            if (child != -1 && same_decision_point(nodes[child].state, observed) && nodes[child].state.depth < 200) {
+                keep_subtree(child);
+                committed = -1;
+                reused_tree = true;
+                return;
+            }
+        }
+    }
+
+    reset();
+    reused_tree = false;
+    root = new_node(observed, -1, (uint8_t) BOSS_STATE::SIZE);
+}
+
+void MctsBossPlanner::keep_subtree(int new_root) {
+    // copy the subtree breadth first into the spare pool, so the rest of the pool is free again
+    spare.clear();
+    spare.push_back(nodes[new_root]);
+    spare[0].parent = -1;
+    for (size_t i = 0; i < spare.size(); i++) {
+        for (int& child: spare[i].children) {
+            if (child == -1)
+                continue;
+            spare.push_back(nodes[child]);
+            spare.back().parent = (int) i;
+            child = (int) spare.size() - 1;
+        }
+    }
+    std::swap(nodes, spare);
+    root = 0;
+}
+
+int MctsBossPlanner::select_action(const Node& node) const {
+    int best = -1;
+    float best_score = 0;
+    float log_visits = std::log((float) node.visits + 1);
+    for (int child: node.children) {
+        if (child == -1)
+            continue;
+        const Node& chance = nodes[child];
+        if (chance.visits == 0)
+            return child;
+        // rewards are on the scale of MDP_BASE_REWARD, so is the exploration term
+        float score = chance.value_sum / chance.visits + MCTS_EXPLORATION * MDP_BASE_REWARD * sqrt(log_visits / chance.visits);
+        if (best == -1 || score > best_score) {
+            best = child;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+float MctsBossPlanner::rollout(BossPlanState state, uint depth) {
+    float value = 0;
+    float discount = 1;
+    for (; depth <= MCTS_HORIZON; depth++) {
+        uint ready[BOSS_PLAN_ACTION_COUNT];
+        uint num_ready = 0;
+        for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++)
+            if (state.cooldowns[i] <= 0)
+                ready[num_ready++] = i;
+        if (num_ready == 0)
+            break;
+
+        BOSS_STATE action = (BOSS_STATE) ready[next_random() % num_ready];
+        BossPlanState next;
+        value += discount * plan_transition(*context, action, state, next_random() % plan_outcome_count(action, state), next);
+        discount *= MDP_DISCOUNT_FACTOR;
+        state = next;
+    }
+    return value;
+}
+
+void MctsBossPlanner::iterate() {
+    // chance nodes along the path, with the reward collected right after each
+    int path[MCTS_HORIZON + 2];
+    float rewards[MCTS_HORIZON + 2];
+    uint length = 0;
+
+    int node = root;
+    uint root_depth = nodes[root].state.depth;
+    float leaf_value = 0;
+    while (true) {
+        uint depth = nodes[node].state.depth - root_depth;
+        if (depth > MCTS_HORIZON)
+            break;
+
+        if (!nodes[node].expanded) {
+            for (uint i = 0; i < BOSS_PLAN_ACTION_COUNT; i++) {
+                if (nodes[node].state.cooldowns[i] <= 0) {
+                    int chance = new_node(nodes[node].state, node, (uint8_t) i);
+                    if (chance == -1)
+                        break;
+                    nodes[node].children[i] = chance;
+                }
+            }
+            nodes[node].expanded = true;
+        }
+
+        int chance = select_action(nodes[node]);
+        if (chance == -1)
+            break;
+
+        BOSS_STATE action = (BOSS_STATE) nodes[chance].action;
+        uint outcome = next_random() % plan_outcome_count(action, nodes[node].state);
+        BossPlanState next;
+        path[length] = chance;
+        rewards[length] = plan_transition(*context, action, nodes[node].state, outcome, next);
+        length++;
+
+        int child = nodes[chance].children[outcome];
+        if (child == -1) {
+            // new outcome, add it to the tree (if there is room) and estimate it with a rollout
+            nodes[chance].children[outcome] = new_node(next, chance, (uint8_t) BOSS_STATE::SIZE);
+            leaf_value = rollout(next, depth + 1);
+            break;
+        }
+        node = child;
+    }
+
+    // back the discounted return up through the chance nodes and their parents
+    float value = leaf_value;
+    if (length == 0)
+        nodes[node].visits++;
+    for (int i = (int) length - 1; i >= 0; i--) {
+        value = rewards[i] + MDP_DISCOUNT_FACTOR * value;
+        Node& chance = nodes[path[i]];
+        chance.visits++;
+        chance.value_sum += value;
+        nodes[chance.parent].visits++;
+    }
+}
+
+void MctsBossPlanner::think(const BossPlanState& observed, const BossPlanContext& context, float budget_us, bool acting) {
+    this->context = &context;
+    // while an action plays out the world is between decision points, keep growing the current tree
+    if (!acting || root == -1)
+        set_root(observed);
+
+    auto start = std::chrono::steady_clock::now();
+    uint done = 0;
+    while (true) {
+        // the clock is only read every few iterations, a single one is well under a microsecond
+        if (done % 16 == 0) {
+            float spent_us = (float) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            if (spent_us >= budget_us)
+                break;
+        }
+        iterate();
+        done++;
+    }
+    iterations += done;
+    root_visits = nodes[root].visits;
+    nodes_used = (uint) nodes.size();
+    this->context = nullptr;
+}
+
+BOSS_STATE MctsBossPlanner::commit(const BossPlanState& observed, const BossPlanContext& context) {
+    this->context = &context;
+    set_root(observed);
+    while (nodes[root].visits < MCTS_MIN_ITERATIONS)
+        iterate();
+    root_visits = nodes[root].visits;
+    nodes_used = (uint) nodes.size();
+
+    int best = -1;
+    for (int child: nodes[root].children) {
+        if (child != -1 && nodes[child].visits > 0 && (best == -1 || nodes[child].visits > nodes[best].visits))
+            best = child;
+    }
+    this->context = nullptr;
+
+    iterations = 0;
+    // same rule as the expectimax planner, idle unless the best action is worth something
+    if (best == -1 || nodes[best].value_sum <= 0) {
+        committed = -1;
+        return BOSS_STATE::SIZE;
+    }
+    committed = best;
+    return (BOSS_STATE) nodes[best].action;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "components.hpp"
+#include "perception.hpp"
+
+// stlib
+#include <cstdint>
+#include <vector>
+
+// Platforms (indices into walkable_area) the boss may teleport to
+const int BOSS_PLAN_PLATFORMS[] = { 0, 1, 2, 7 };
+const uint BOSS_PLAN_PLATFORM_COUNT = 4;
+// Extra cell for when the boss is not standing on one of the platforms above
+const uint BOSS_PLAN_CELL_OFFGRID = BOSS_PLAN_PLATFORM_COUNT;
+const uint BOSS_PLAN_CELL_COUNT = BOSS_PLAN_PLATFORM_COUNT + 1;
+const uint BOSS_PLAN_ACTION_COUNT = (uint) BOSS_STATE::SIZE;
+// Must be a power of two, probing wraps with a mask
+const uint BOSS_PLAN_TABLE_SIZE = 4096;
+// Most outcomes a single action can have (summoning 3 to 7 ghouls)
+const uint BOSS_PLAN_MAX_OUTCOMES = 5;
+
+// MCTS configuration, the horizon is deeper than MDP_HORIZON since the search is spread over frames
+const uint MCTS_HORIZON = 4;
+const uint MCTS_NODE_CAPACITY = 16384;
+const float MCTS_FRAME_BUDGET_US = 300.f;
+// range the per frame budget can be scaled within at runtime, for A/B runs
+const float MCTS_MIN_BUDGET_US = 25.f;
+const float MCTS_MAX_BUDGET_US = 4800.f;
+const float MCTS_EXPLORATION = 1.4f;
+// iterations guaranteed before committing, in case the tree is cold
+const uint MCTS_MIN_ITERATIONS = 200;
+
+enum class BOSS_PLANNER_TYPE {
+	EXPECTIMAX = 0,
+	MCTS = EXPECTIMAX + 1,
+	TYPE_COUNT = MCTS + 1
+};
+
+// Everything the search branches on. Plain bytes so it can be hashed and compared directly,
+// always build it zeroed
+struct BossPlanState
+{
+	uint8_t boss_cell;
+	uint8_t num_ghouls;
+	uint8_t num_spitters;
+	// number of actions already taken from the root
+	uint8_t depth;
+	// remaining cooldown per action, anything ready is stored as exactly 0
+	float cooldowns[BOSS_PLAN_ACTION_COUNT];
+};
+
+// World facts that stay fixed during one decision, gathered once before searching
+struct BossPlanContext
+{
+	bool player_has_sword;
+	// distance from the player to the boss' bounding box when the boss stands in each cell
+	float player_dist[BOSS_PLAN_CELL_COUNT];
+	float swipe_reward[BOSS_PLAN_CELL_COUNT];
+	float bullet_reward[BOSS_PLAN_CELL_COUNT];
+};
+
+BossPlanState make_boss_plan_state(Entity boss);
+BossPlanContext make_boss_plan_context(Entity player_hero, Entity boss, Perception& perception);
+
+// Number of equally likely outcomes of taking the action in the state
+uint plan_outcome_count(BOSS_STATE action, const BossPlanState& state);
+// Applies one outcome of the action, writes the resulting state and returns the immediate reward
+float plan_transition(const BossPlanContext& context, BOSS_STATE action, const BossPlanState& state, uint outcome, BossPlanState& next);
+
+// Finite horizon expectimax over BOSS_STATE actions, memoized in a fixed size transposition table
+class BossPlanner
+{
+public:
+	// Best action from the root, BOSS_STATE::SIZE if nothing has a positive utility
+	BOSS_STATE decide(const BossPlanState& root, const BossPlanContext& context);
+
+	// stats for the last decision and running totals
+	uint last_expansions = 0;
+	uint last_table_hits = 0;
+	uint decisions = 0;
+	uint64_t total_expansions = 0;
+
+private:
+	struct TableEntry
+	{
+		BossPlanState state;
+		float value;
+		uint generation;
+	};
+
+	float state_value(const BossPlanState& state);
+	float action_value(BOSS_STATE action, const BossPlanState& state);
+
+	const BossPlanContext* context = nullptr;
+	// bumping the generation invalidates every entry without touching the table
+	uint generation = 0;
+	TableEntry table[BOSS_PLAN_TABLE_SIZE] = {};
+};
+
+// Anytime Monte Carlo tree search, fed a slice of time every frame. The tree is kept between
+// decisions and re-rooted on whatever outcome the committed action actually had.
+class MctsBossPlanner
+{
+public:
+	MctsBossPlanner();
+
+	// Searches for at most budget_us microseconds. While the boss is acting the observed state is
+	// in between decisions, so the current root is kept
+	void think(const BossPlanState& root, const BossPlanContext& context, float budget_us, bool acting);
+	// Picks the most visited action, BOSS_STATE::SIZE if none is expected to pay off
+	BOSS_STATE commit(const BossPlanState& root, const BossPlanContext& context);
+	void reset();
+
+	// microseconds searched per frame, see scale_boss_planner_budget
+	float budget_us = MCTS_FRAME_BUDGET_US;
+
+	// stats since the last commit
+	uint iterations = 0;
+	uint root_visits = 0;
+	uint nodes_used = 0;
+	bool reused_tree = false;
+
+private:
+	struct Node
+	{
+		// decision nodes hold the state, chance nodes the state the action was taken from
+		BossPlanState state;
+		int parent;
+		// decision node: chance node per action, chance node: decision node per outcome. -1 if none
+		int children[BOSS_PLAN_MAX_OUTCOMES];
+		uint8_t action;
+		bool expanded;
+		uint visits;
+		float value_sum;
+	};
+
+	void set_root(const BossPlanState& root);
+	void keep_subtree(int new_root);
+	int new_node(const BossPlanState& state, int parent, uint8_t action);
+	void iterate();
+	float rollout(BossPlanState state, uint depth);
+	int select_action(const Node& node) const;
+	uint32_t next_random();
+
+	const BossPlanContext* context = nullptr;
+	std::vector<Node> nodes;
+	std::vector<Node> spare;
+	int root = -1;
+	// chance node of the last committed action, its outcomes are candidates for the next root
+	int committed = -1;
+	uint32_t rng_state = 0x9E3779B9u;
+};
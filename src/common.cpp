@@ -1,5 +1,8 @@
 #include "common.hpp"
 
+// stlib
+#include <cstring>
+
 // Note, we could also use the functions from GLM but we write the transformations here to show the uderlying math
 void Transform::scale(vec2 scale)
 {
@@ -55,4 +58,16 @@ bool gl_has_errors()
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+bool gl_has_extension(const char *name)
+{
+	GLint extension_count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+	for (GLint i = 0; i < extension_count; i++) {
+		const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
@@ -53,3 +53,5 @@ struct Transform {
 };
 
 bool gl_has_errors();
+// Whether the context lists the extension, e.g. "GL_ARB_buffer_storage"
+bool gl_has_extension(const char *name);
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include "../ext/stb_image/stb_image.h"
 #include <list>
+#include <string>
 
 enum class COLLECTABLE_TYPE
 {
@@ -79,10 +80,9 @@ struct Block
 {
 };
 
-struct ParallaxBackground
+// The lava along the bottom of the level, drawn with the parallax background
+struct Lava
 {
-	// where to reset entity to once it reaches end of screen
-	vec2 resetPosition;
 };
 
 struct Enemies
@@ -170,7 +170,9 @@ struct Rocket {
 struct GrenadeLauncher {
 	float cooldown = 0;
 	bool loaded = true;
-	std::vector<Entity> trajectory;
+	// predicted path relative to trajectory_origin, which follows the launcher's muzzle
+	std::vector<vec2> trajectory;
+	vec2 trajectory_origin = {0, 0};
 };
 
 struct Grenade {
@@ -206,7 +208,8 @@ struct WaterBall {
 	float start_length;
 	float t = 0;
 	uint curve_num = 0;
-	std::vector<Entity> trajectory;
+	// the drawn path (every other point) is shown until the ball is fired
+	bool show_trajectory = true;
 };
 
 // Weapon the player has picked up
@@ -254,6 +257,14 @@ struct TestAI
 	float a;
 	float b;
 	float c;
+	// current leg of the flight, x moves linearly in time from the edge it departed from.
+	// x_speed is 0 until the AI system first sees the fireling
+	float start_ms = 0.f;
+	float x_speed = 0.f;
+	// per fireling xorshift state for picking the next curve, 0 until seeded
+	uint rng_state = 0;
+	// last known index in registry.motions, checked before use
+	uint motion_index = 0;
 };
 
 // Gravity is valid for all entities in this struct
@@ -309,7 +320,7 @@ struct ColoredVertex
 	vec3 color;
 };
 
-// Single Vertex Buffer element for textured sprites (textured.vs.glsl)
+// Single Vertex Buffer element for textured sprites (sprite.vs.glsl)
 struct TexturedVertex
 {
 	vec3 position;
@@ -324,6 +335,10 @@ struct AnimationInfo
 	int stateCycleLength;
     int oneTimeState = -1;
 	double oneTimer;
+	// written by the animation system: sprite sheet cell (frame, state) shown, held while paused or
+	// dying, and the same cell as (u, v, width, height) within the texture
+	vec2 shown_frame = {0, 0};
+	vec4 frame_rect = {0, 0, 1, 1};
 };
 
 struct ShowWhenPaused {
@@ -481,7 +496,9 @@ enum class TEXTURE_ASSET_ID
 	DIALOGUE_8 = DIALOGUE_7 + 1,
 	DB_BOSS_SINGLE = DIALOGUE_8 + 1,
 	DB_BROKEN_SINGLE = DB_BOSS_SINGLE + 1,
-	TEXTURE_COUNT = DB_BROKEN_SINGLE + 1
+	// built by the renderer, see glyph_atlas.hpp
+	GLYPHS = DB_BROKEN_SINGLE + 1,
+	TEXTURE_COUNT = GLYPHS + 1
 };
 
 const int texture_count = (int)TEXTURE_ASSET_ID::TEXTURE_COUNT;
@@ -501,15 +518,15 @@ enum class EFFECT_ASSET_ID
 	SPITTER_ENEMY = GHOUL + 1,
 	SPITTER_ENEMY_BULLET = SPITTER_ENEMY + 1,
 	FOLLOWING_ENEMY = SPITTER_ENEMY_BULLET + 1,
-    SCREEN_LAYER = FOLLOWING_ENEMY + 1,
-	LAVA_PILLAR = SCREEN_LAYER + 1,
+	LAVA_PILLAR = FOLLOWING_ENEMY + 1,
     BOSS = LAVA_PILLAR + 1,
 	BOSS_SWORD_S = BOSS + 1,
 	BOSS_SWORD_L = BOSS_SWORD_S + 1,
     HEALTH_BAR = BOSS_SWORD_L + 1,
-	DIALOGUE_LAYER = HEALTH_BAR + 1,
-	GRENADE_ORB = DIALOGUE_LAYER + 1,
-	EFFECT_COUNT = GRENADE_ORB + 1,
+	GRENADE_ORB = HEALTH_BAR + 1,
+	SPRITE_INSTANCED = GRENADE_ORB + 1,
+	PARALLAX = SPRITE_INSTANCED + 1,
+	EFFECT_COUNT = PARALLAX + 1,
 };
 const int effect_count = (int)EFFECT_ASSET_ID::EFFECT_COUNT;
 
@@ -524,13 +541,49 @@ enum class GEOMETRY_BUFFER_ID
 };
 const int geometry_count = (int)GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
 
+// Layers are drawn in this order, the full screen dialogue dim goes between WORLD and DIALOGUE
+// and the screen effects between DIALOGUE and OVERLAY
+enum class RENDER_LAYER
+{
+	BACKGROUND = 0,
+	WORLD = BACKGROUND + 1,
+	DIALOGUE = WORLD + 1,
+	OVERLAY = DIALOGUE + 1,
+	// hitboxes, only drawn by the renderer in debug mode
+	DEBUG = OVERLAY + 1,
+	LAYER_COUNT = DEBUG + 1
+};
+
 struct RenderRequest
 {
 	TEXTURE_ASSET_ID used_texture = TEXTURE_ASSET_ID::TEXTURE_COUNT;
 	EFFECT_ASSET_ID used_effect = EFFECT_ASSET_ID::EFFECT_COUNT;
 	GEOMETRY_BUFFER_ID used_geometry = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
-    bool on_top_screen = false;
+    RENDER_LAYER layer = RENDER_LAYER::WORLD;
     bool visibility = true;
     vec2 scale = {1,1};
     vec2 offset = {0,0};
+    // order within the layer, higher is drawn on top. Equal depths are grouped by effect and texture
+    int depth = 0;
+};
+
+enum class TEXT_ALIGN
+{
+	LEFT = 0,
+	CENTER = LEFT + 1,
+	RIGHT = CENTER + 1
+};
+
+// A line of text drawn from the glyph atlas, the entity's motion position is where it is aligned to,
+// vertically centered. All glyphs of a string go out in one sprite batch
+struct Text
+{
+	std::string string;
+	// glyph height and extra gap between glyphs, in pixels
+	float size = 29.f;
+	float spacing = 0.f;
+	vec3 color = { 1.f, 1.f, 1.f };
+	TEXT_ALIGN align = TEXT_ALIGN::LEFT;
+	RENDER_LAYER layer = RENDER_LAYER::OVERLAY;
+	bool visibility = true;
 };
@@ -4,11 +4,15 @@
 
 
 #include "enemy_utils.hpp"
-#include "physics_system.hpp"
 
 
 static std::default_random_engine rng = std::default_random_engine(std::random_device()());
 static std::uniform_real_distribution<float> uniform_dist;
+static BossPlanner boss_planner;
+static MctsBossPlanner mcts_boss_planner;
+static BOSS_PLANNER_TYPE boss_planner_type = BOSS_PLANNER_TYPE::EXPECTIMAX;
+
+float spitter_projectile_delay_ms = 5000.f;
 
 void do_enemy_spawn(float elapsed_ms, RenderSystem* renderer, int ddl) {
     adjust_difficulty(ddl);
@@ -94,232 +98,7 @@ void adjust_difficulty(int ddl){
 }
 
 
-void move_firelings(RenderSystem* renderer)
-{
-    auto &testAI_container = registry.testAIs;
-    for (uint i = 0; i < testAI_container.size(); i++)
-    {
-        TestAI &testAI = testAI_container.components[i];
-        Entity entity = testAI_container.entities[i];
-        Motion &motion = registry.motions.get(entity);
-        if (testAI.departFromRight && motion.position[0] < 0)
-        {
-            float squareFactor = rand() % 2 == 0 ? 0.0005 : -0.0005;
-            int rightHeight = ENEMY_SPAWN_HEIGHT_IDLE_RANGE + rand() % (window_height_px - ENEMY_SPAWN_HEIGHT_IDLE_RANGE * 2);
-            motion.position = vec2(0.0, testAI.c);
-            float curveParameter = (float)(rightHeight - testAI.c - window_width_px * window_width_px * squareFactor) / window_width_px;
-            testAI.departFromRight = false;
-            testAI.a = (float)squareFactor;
-            testAI.b = curveParameter;
-            motion.dir = 1;
-        }
-        else if (!testAI.departFromRight && motion.position[0] > window_width_px)
-        {
-            float squareFactor = rand() % 2 == 0 ? 0.0005 : -0.0005;
-            int rightHeight = testAI.a * window_width_px * window_width_px + testAI.b * window_width_px + testAI.c;
-            int leftHeight = ENEMY_SPAWN_HEIGHT_IDLE_RANGE + rand() % (window_height_px - ENEMY_SPAWN_HEIGHT_IDLE_RANGE * 2);
-            motion.position = vec2(window_width_px, rightHeight);
-            float curveParameter = (float)(rightHeight - leftHeight - window_width_px * window_width_px * squareFactor) / window_width_px;
-            testAI.departFromRight = true;
-            testAI.a = (float)squareFactor;
-            testAI.b = curveParameter;
-            testAI.c = (float)leftHeight;
-            motion.dir = -1;
-        }
-        float gradient = 2 * testAI.a * motion.position[0] + testAI.b;
-        float basicFactor = sqrt(BASIC_SPEED * BASIC_SPEED / (gradient * gradient + 1));
-        float direction = testAI.departFromRight ? -1.0 : 1.0;
-        motion.velocity = direction * vec2(basicFactor, gradient * basicFactor);
-    }
-}
-
-void move_boulder(RenderSystem* renderer) {
-    for (Entity boulder: registry.boulders.entities) {
-        Motion& motion = registry.motions.get(boulder);
-        if (motion.velocity.x > 0) {
-            motion.angle += M_PI / 64;
-        } else if (motion.velocity.x < 0) {
-            motion.angle -= M_PI / 64;
-        }
-    }
-}
-
-void move_ghouls(RenderSystem* renderer, Entity player_hero)
-{
-    float GHOUL_SPEED = 100.f;
-    float EDGE_DISTANCE = 0.f;
-
-    registry.motions.get(player_hero);
-    for (uint i = 0; i < registry.ghouls.entities.size(); i++) {
-        Entity enemy = registry.ghouls.entities[i];
-        Motion& enemy_motion = registry.motions.get(enemy);
-        AnimationInfo& animation = registry.animated.get(enemy);
-        Ghoul& enemy_reg = registry.ghouls.get(enemy);
-        //printf("Position: %f\n", enemy_motion.position.x);
-        if (enemy_reg.left_x != -1.f && enemy_motion.velocity.x == 0.f && enemy_motion.velocity.y == 0.f && animation.oneTimeState == -1) {
-            float direction = max(enemy_motion.position.x - enemy_reg.left_x, enemy_reg.right_x - enemy_motion.position.x);
-            direction = direction / abs(direction);
-            enemy_motion.velocity.x = direction * GHOUL_SPEED;
-            enemy_motion.dir = (int)direction;
-        }
-            // Reverse direction
-        else if (enemy_motion.position.x - enemy_reg.left_x <= EDGE_DISTANCE && enemy_motion.velocity.y == 0.f && enemy_motion.velocity.x != 0.f) {
-            enemy_motion.velocity.x = GHOUL_SPEED;
-            enemy_motion.dir = 1;
-        }
-        else if (enemy_reg.right_x - enemy_motion.position.x <= EDGE_DISTANCE && enemy_motion.velocity.y == 0.f && enemy_motion.velocity.x != 0.f) {
-            enemy_motion.velocity.x = -1.f * GHOUL_SPEED;
-            enemy_motion.dir = -1;
-        }
-    }
-}
-
-void move_tracer(float elapsed_ms_since_last_update, Entity player_hero)
-{
-    const uint PHASE_IN_STATE = 1;
-    const uint PHASE_OUT_STATE = 4;
-
-    Motion& hero_motion = registry.motions.get(player_hero);
-    for (uint i = 0; i < registry.followingEnemies.entities.size(); i++) {
-        Entity enemy = registry.followingEnemies.entities[i];
-        Motion& enemy_motion = registry.motions.get(enemy);
-        AnimationInfo& animation = registry.animated.get(enemy);
-        FollowingEnemies& enemy_reg = registry.followingEnemies.get(enemy);
-
-        enemy_reg.next_blink_time -= elapsed_ms_since_last_update;
-        if (enemy_reg.next_blink_time < 0.f && enemy_reg.blinked == false)
-        {
-            //Time between blinks
-            enemy_reg.next_blink_time = 700.f;
-
-            //enemies.hittable = true;
-            //enemy_reg.hittable = true;
-
-            if (enemy_reg.path.size() == 0 && find_map_index(enemy_motion.position) != find_map_index(hero_motion.position)) {
-                std::vector<std::vector<char>> vec = grid_vec;
-                bfs_follow_start(vec, enemy_motion.position, hero_motion.position, enemy);
-            }
-
-            //Don't blink when not moving: next pos in path is same pos as current
-            if (enemy_reg.path.size() != 0 && find_index_from_map(enemy_reg.path.back()) == enemy_motion.position) {
-                enemy_reg.path.pop_back();
-            }
-            else if (enemy_reg.path.size() != 0)
-            {
-                animation.oneTimeState = PHASE_IN_STATE;
-                animation.oneTimer = 0;
-                vec2 converted_pos = find_index_from_map(enemy_reg.path.back());
-                enemy_motion.dir = (converted_pos.x > enemy_motion.position.x) ? -1 : 1;
-                enemy_motion.position = converted_pos;
-                enemy_reg.path.pop_back();
-
-                //Don't blink when not moving: next loop will be to re-calc the path
-                if (enemy_reg.path.size() != 0) {
-                    enemy_reg.blinked = true;
-                }
-            }
-        }
-
-        if (enemy_reg.next_blink_time < 0.0f && enemy_reg.blinked == true) {
-            enemy_reg.next_blink_time = 100.f;
-            animation.oneTimeState = PHASE_OUT_STATE;
-            animation.oneTimer = 0;
-            //enemy_reg.hittable = false;
-            //enemies.hittable = false;
-            enemy_reg.blinked = false;
-        }
-    }
-}
-
-void move_spitters(float elapsed_ms_since_last_update, RenderSystem* renderer) {
-    const uint SHOOT_STATE = 2;
-    const uint SPITTER_FIRE_FRAME = 4;
-    const uint WALKING_TIME = 5;
-    const float WALKING_SPEED = 100.f;
-    float EDGE_DISTANCE = 10.f;
-    const float STOP_WALK_TIME = 300.f;
-
-    auto &spitterEnemy_container = registry.spitterEnemies;
-    for (uint i = 0; i < spitterEnemy_container.size(); i++)
-    {
-        SpitterEnemy &spitterEnemy = spitterEnemy_container.components[i];
-        spitterEnemy.timeUntilNextShotMs -= elapsed_ms_since_last_update;
-        Entity entity = spitterEnemy_container.entities[i];
-        Motion &motion = registry.motions.get(entity);
-        AnimationInfo &animation = registry.animated.get(entity);
-
-        if (!spitterEnemy.canShoot && spitterEnemy.timeUntilNextShotMs > STOP_WALK_TIME && motion.velocity.y == 0.f && animation.oneTimeState != 2) {
-            if (spitterEnemy.left_x != -1.f && motion.velocity.x == 0.f) {
-                float direction;
-                if (motion.position.x <= spitterEnemy.left_x || motion.position.x >= spitterEnemy.right_x) {
-                    direction = max(motion.position.x - spitterEnemy.left_x, spitterEnemy.right_x - motion.position.x);
-                }
-                else {
-                    direction = (rand() % 2) - 0.5f;
-                }
-
-                direction = direction / abs(direction);
-                motion.velocity.x = direction * WALKING_SPEED;
-                motion.dir = (int)direction;
-            }
-                // Reverse direction
-            else if (motion.position.x - spitterEnemy.left_x <= EDGE_DISTANCE && motion.velocity.x != 0.f) {
-                motion.velocity.x = WALKING_SPEED;
-                motion.dir = 1;
-            }
-            else if (spitterEnemy.right_x - motion.position.x <= EDGE_DISTANCE && motion.velocity.x != 0.f) {
-                motion.velocity.x = -1.f * WALKING_SPEED;
-                motion.dir = -1;
-            }
-        }
-        else if (spitterEnemy.canShoot || spitterEnemy.timeUntilNextShotMs <= STOP_WALK_TIME) {
-            motion.velocity.x = 0;
-        }
-
-        animation.curState = (motion.velocity.x != 0)? 1: 0;
-
-        if (animation.oneTimeState == SHOOT_STATE && (int)floor(animation.oneTimer * ANIMATION_SPEED_FACTOR) == SPITTER_FIRE_FRAME && spitterEnemy.canShoot) {
-            Entity spitterBullet = createSpitterEnemyBullet(renderer, motion.position, motion.angle);
-            float absolute_scale_x = abs(registry.motions.get(entity).scale[0]);
-            if (registry.motions.get(spitterBullet).velocity[0] < 0.0f)
-                registry.motions.get(entity).scale[0] = -absolute_scale_x;
-            else
-                registry.motions.get(entity).scale[0] = absolute_scale_x;
-            spitterEnemy.canShoot = false;
-        }
-        if (spitterEnemy.timeUntilNextShotMs <= 0.f && registry.enemies.get(entity).hitting == true)
-        {
-            // attack animation
-            animation.oneTimeState = SHOOT_STATE;
-            animation.oneTimer = 0;
-            spitterEnemy.canShoot = true;
-            // create bullet at same position as enemy
-            spitterEnemy.timeUntilNextShotMs = spitter_projectile_delay_ms;
-        }
-    }
-
-    // decay spitter bullets
-    auto& spitterBullets_container = registry.spitterBullets;
-    for (uint i = 0; i < spitterBullets_container.size(); i++)
-    {
-        SpitterBullet& spitterBullet = spitterBullets_container.components[i];
-        Entity entity = spitterBullets_container.entities[i];
-        RenderRequest& render = registry.renderRequests.get(entity);
-        Motion& motion = registry.motions.get(entity);
-        // make bullets smaller over time
-        motion.scale = vec2(motion.scale.x / spitterBullet.mass, motion.scale.y / spitterBullet.mass);
-        spitterBullet.mass -= elapsed_ms_since_last_update / SPITTER_PROJECTILE_REDUCTION_FACTOR;
-        motion.scale = vec2(motion.scale.x * spitterBullet.mass, motion.scale.y * spitterBullet.mass);
-        render.scale = motion.scale;
-        if (spitterBullet.mass <= SPITTER_PROJECTILE_MIN_SIZE)
-        {
-            spitterBullet.mass = 0;
-            registry.remove_all_components_of(entity);
-        }
-    }
-}
-
-void boss_action_decision(Entity player_hero, Entity boss, RenderSystem* renderer, float elapsed_ms){
+void boss_action_decision(Entity player_hero, Entity boss, RenderSystem* renderer, float elapsed_ms, Perception& perception){
     Boss& boss_state = registry.boss.get(boss);
     AnimationInfo& info = registry.animated.get(boss);
     // 11 and 12 are hurt and death animation
@@ -336,6 +115,11 @@ void boss_action_decision(Entity player_hero, Entity boss, RenderSystem* rendere
         if (cd > 0)
             cd -= elapsed_ms;
 
+    // the MCTS planner searches a little every frame, ready for when the cooldown runs out
+    if (boss_planner_type == BOSS_PLANNER_TYPE::MCTS)
+        mcts_boss_planner.think(make_boss_plan_state(boss), make_boss_plan_context(player_hero, boss, perception),
+                                mcts_boss_planner.budget_us, boss_state.state != BOSS_STATE::SIZE);
+
     switch (boss_state.state) {
         case BOSS_STATE::TELEPORT:
             boss_action_teleport(boss);
@@ -354,7 +138,7 @@ void boss_action_decision(Entity player_hero, Entity boss, RenderSystem* rendere
             break;
         case BOSS_STATE::SIZE:
             if (boss_state.cooldowns[(uint) BOSS_STATE::SIZE] <= 0)
-                boss_state.state = get_action(player_hero, boss, renderer);
+                boss_state.state = get_action(player_hero, boss, perception);
             break;
     }
 }
@@ -511,149 +295,48 @@ void boss_action_sword_spawn(bool create, vec2 pos, vec2 scale, RenderSystem* re
     //}
 }
 
-BOSS_STATE get_action(Entity player_hero, Entity boss, RenderSystem* renderer) {
-    vec2 boss_pos = registry.motions.get(boss).position;
-    uint num_ghouls = registry.ghouls.entities.size();
-    uint num_spitters = registry.spitterEnemies.entities.size();
+BOSS_STATE get_action(Entity player_hero, Entity boss, Perception& perception) {
+    BossPlanState root = make_boss_plan_state(boss);
+    BossPlanContext context = make_boss_plan_context(player_hero, boss, perception);
     BOSS_STATE action;
-    float max_utility = 0;
-    for (uint i = 0; i < (uint) BOSS_STATE::SIZE; i++) {
-        if (registry.boss.components[0].cooldowns[i] <= 0) {
-            float utility = get_action_reward((BOSS_STATE) i, boss_pos, num_ghouls, num_spitters, 0, registry.boss.components[0].cooldowns, player_hero, boss, renderer);
-            if (utility > max_utility) {
-                max_utility = utility;
-                action = (BOSS_STATE) i;
-            }
-        }
-    }
-    if (max_utility == 0) {
-        action = BOSS_STATE::SIZE;
+    if (boss_planner_type == BOSS_PLANNER_TYPE::MCTS) {
+        uint iterations = mcts_boss_planner.iterations;
+        action = mcts_boss_planner.commit(root, context);
+        if (WorldSystem::debug)
+            printf("Boss planner (MCTS, %.0f us per frame): action %u after %u iterations, %u root visits, %u nodes, tree %s\n",
+                   mcts_boss_planner.budget_us, (uint) action, iterations, mcts_boss_planner.root_visits, mcts_boss_planner.nodes_used,
+                   mcts_boss_planner.reused_tree ? "reused" : "fresh");
     } else {
-        registry.boss.components[0].cooldowns[(uint) BOSS_STATE::SIZE] = BOSS_ACTION_COOLDOWNS[(uint) BOSS_STATE::SIZE];
-        registry.boss.components[0].cooldowns[(uint) action] = BOSS_ACTION_COOLDOWNS[(uint) action];
+        action = boss_planner.decide(root, context);
+        if (WorldSystem::debug)
+            printf("Boss planner (expectimax): action %u after %u expansions, %u table hits (%.1f expansions per decision over %u decisions)\n",
+                   (uint) action, boss_planner.last_expansions, boss_planner.last_table_hits,
+                   (double) boss_planner.total_expansions / boss_planner.decisions, boss_planner.decisions);
     }
-    return action;
-}
 
-
-
-float mdp_helper(vec2 boss_pos, uint num_ghouls, uint num_spitters, uint step_num, std::vector<float> cooldowns, Entity player_hero, Entity boss, RenderSystem* renderer) {
-    float max_utility = 0;
-    if (step_num <= MDP_HORIZON) {
-        for (uint i = 0; i < (uint) BOSS_STATE::SIZE; i++) {
-            if (cooldowns[i] <= 0) {
-                float utility = get_action_reward((BOSS_STATE) i, boss_pos, num_ghouls, num_spitters, step_num, cooldowns, player_hero, boss, renderer);
-                if (utility > max_utility) {
-                    max_utility = utility;
-                }
-            }
-        }
+    if (action != BOSS_STATE::SIZE) {
+        Boss& boss_state = registry.boss.get(boss);
+        boss_state.cooldowns[(uint) BOSS_STATE::SIZE] = BOSS_ACTION_COOLDOWNS[(uint) BOSS_STATE::SIZE];
+        boss_state.cooldowns[(uint) action] = BOSS_ACTION_COOLDOWNS[(uint) action];
     }
-    return max_utility;
+    return action;
 }
 
-float get_action_reward(BOSS_STATE action, vec2 boss_pos, uint num_ghouls, uint num_spitters, uint step_num, std::vector<float> cooldowns, Entity player_hero, Entity boss, RenderSystem* renderer) {
-    cooldowns[(uint) action] = BOSS_ACTION_COOLDOWNS[(uint) action];
-    for (float& cd: cooldowns)
-        if (cd > 0)
-            cd -= BOSS_ACTION_COOLDOWNS[(uint) BOSS_STATE::SIZE];
-    float reward = 0;
-    switch (action) {
-        case BOSS_STATE::TELEPORT: {
-            vec2 new_pos = getRandomWalkablePos(ASSET_SIZE.at(TEXTURE_ASSET_ID::BOSS), 0, false);
-            if (new_pos != boss_pos) {
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, new_pos, num_ghouls, num_spitters, player_hero, boss) +
-                        MDP_DISCOUNT_FACTOR * mdp_helper(new_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer)) / 3.f;
-            }
-
-            new_pos = getRandomWalkablePos(ASSET_SIZE.at(TEXTURE_ASSET_ID::BOSS), 1, false);
-            if (new_pos != boss_pos) {
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, new_pos, num_ghouls, num_spitters, player_hero, boss) +
-                        MDP_DISCOUNT_FACTOR * mdp_helper(new_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer)) / 3.f;
-            }
-
-            new_pos = getRandomWalkablePos(ASSET_SIZE.at(TEXTURE_ASSET_ID::BOSS), 2, false);
-            if (new_pos != boss_pos) {
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, new_pos, num_ghouls, num_spitters, player_hero, boss) +
-                        MDP_DISCOUNT_FACTOR * mdp_helper(new_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer)) / 3.f;
-            }
 
-            new_pos = getRandomWalkablePos(ASSET_SIZE.at(TEXTURE_ASSET_ID::BOSS), 7, false);
-            if (new_pos != boss_pos) {
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, new_pos, num_ghouls, num_spitters, player_hero, boss) +
-                        MDP_DISCOUNT_FACTOR * mdp_helper(new_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer)) / 3.f;
-            }
-            break;
-        } case BOSS_STATE::SWIPE: {
-            vec2 pos_dif = {abs(boss_pos.x - registry.motions.get(player_hero).position.x), abs(boss_pos.y - registry.motions.get(player_hero).position.y)};
-            float x_penalty = std::pow(std::pow(MDP_BASE_REWARD, 1.f/20.f), min(pos_dif.x, 300.f) - 280);
-            float y_penalty = std::pow(std::pow(MDP_BASE_REWARD, 1.f/20.f), min(pos_dif.y, 60.f) - 40);
-            reward = MDP_BASE_REWARD - x_penalty - y_penalty + MDP_DISCOUNT_FACTOR * mdp_helper(boss_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer);
-            break;
-        } case BOSS_STATE::SUMMON_GHOULS: {
-            for (uint i = 3; i <= 3 + 4; i++)
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, boss_pos, num_ghouls + i, num_spitters, player_hero, boss) + MDP_DISCOUNT_FACTOR * mdp_helper(boss_pos, num_ghouls + i, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer)) / 5.f;
-            break;
-        } case BOSS_STATE::SUMMON_SPITTERS: {
-            for (uint i = 1; i <= 1 + 3; i++)
-                reward += (get_reward(boss_pos, num_ghouls, num_spitters, boss_pos, num_ghouls, num_spitters + i, player_hero, boss) + MDP_DISCOUNT_FACTOR * mdp_helper(boss_pos, num_ghouls, num_spitters + i, step_num + 1, cooldowns, player_hero, boss, renderer)) / 4.f;
-            break;
-        } case BOSS_STATE::SUMMON_BULLETS: {
-            vec2 line_pos = (boss_pos + registry.motions.get(player_hero).position) / 2.f;
-            vec2 line_scale = {sqrt(dot(boss_pos - registry.motions.get(player_hero).position, boss_pos - registry.motions.get(player_hero).position)), 1.f};
-            float line_angle = atan2(registry.motions.get(player_hero).position.y - boss_pos.y, registry.motions.get(player_hero).position.x - boss_pos.x);
-            Entity line = createLine(renderer, line_pos, {0, 0}, line_scale, line_angle);
-            registry.lasers.emplace(line);
-            registry.collisionMeshPtrs.emplace(line, &(renderer->getCollisionMesh(GEOMETRY_BUFFER_ID::SPRITE)));
-            for (Entity block: registry.blocks.entities) {
-                if (PhysicsSystem::collides(line, block)) {
-                    registry.remove_all_components_of(line);
-                    reward = MDP_BASE_REWARD / 1000.f + MDP_DISCOUNT_FACTOR * mdp_helper(boss_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer);
-                    return reward;
-                }
-            }
-            registry.remove_all_components_of(line);
-            reward = MDP_BASE_REWARD / 2.5f + MDP_DISCOUNT_FACTOR * mdp_helper(boss_pos, num_ghouls, num_spitters, step_num + 1, cooldowns, player_hero, boss, renderer);
-            break;
-        }
-    }
-    return reward;
+void toggle_boss_planner() {
+    boss_planner_type = (BOSS_PLANNER_TYPE) (((uint) boss_planner_type + 1) % (uint) BOSS_PLANNER_TYPE::TYPE_COUNT);
+    mcts_boss_planner.reset();
+    // the running average is printed per planner, so it starts over with each switch
+    boss_planner.decisions = 0;
+    boss_planner.total_expansions = 0;
+    printf("Boss planner: %s\n", boss_planner_type == BOSS_PLANNER_TYPE::MCTS ? "MCTS" : "expectimax");
 }
 
-float get_reward(vec2 boss_pos_old, uint num_ghouls_old, uint num_spitters_old, vec2 boss_pos, uint num_ghouls, uint num_spitters, Entity player_hero, Entity boss) {
-    if (num_ghouls_old != num_ghouls) {
-        return MDP_BASE_REWARD / 7.f * (num_ghouls - num_ghouls_old) * (1 - min(std::pow(2, num_ghouls_old / (float) BOSS_MAX_GHOULS) - 1, (double) 1));
-    } else if (num_spitters_old != num_spitters) {
-        return MDP_BASE_REWARD / 4.f * (num_spitters - num_spitters_old) * (1 - min(std::pow(2, num_spitters_old / (float) BOSS_MAX_SPITTERS) - 1, (double) 1));
-    } else {
-        Player& player = registry.players.get(player_hero);
-        if (player.hasWeapon && registry.swords.has(player.weapon)) {
-            Motion& player_motion = registry.motions.get(player_hero);
-            float x_buffer = max(abs(boss_pos_old.x - player_motion.position.x) - registry.motions.get(boss).scale.x / 2, 0.f);
-            float y_buffer = max(abs(boss_pos_old.y - player_motion.position.y) - registry.motions.get(boss).scale.y / 2, 0.f);
-            float player_dist_old = sqrt(dot(vec2(x_buffer, y_buffer), vec2(x_buffer, y_buffer)));
-            x_buffer = max(abs(boss_pos.x - player_motion.position.x) - registry.motions.get(boss).scale.x / 2, 0.f);
-            y_buffer = max(abs(boss_pos.y - player_motion.position.y) - registry.motions.get(boss).scale.y / 2, 0.f);
-            float player_dist = sqrt(dot(vec2(x_buffer, y_buffer), vec2(x_buffer, y_buffer)));
-            if (player_dist_old < 150)
-                return MDP_BASE_REWARD * 1000;
-            else {
-                return MDP_BASE_REWARD * (1 - min(std::pow(2, player_dist_old / 300.f) - 1, (double) 1)) * max(min((player_dist - player_dist_old) / 100.f, 1.f), -1.f);
-            }
-        } else {
-            Motion& player_motion = registry.motions.get(player_hero);
-            float x_buffer = max(abs(boss_pos_old.x - player_motion.position.x) - registry.motions.get(boss).scale.x / 2, 0.f);
-            float y_buffer = max(abs(boss_pos_old.y - player_motion.position.y) - registry.motions.get(boss).scale.y / 2, 0.f);
-            float player_dist_old = sqrt(dot(vec2(x_buffer, y_buffer), vec2(x_buffer, y_buffer)));
-            x_buffer = max(abs(boss_pos.x - player_motion.position.x) - registry.motions.get(boss).scale.x / 2, 0.f);
-            y_buffer = max(abs(boss_pos.y - player_motion.position.y) - registry.motions.get(boss).scale.y / 2, 0.f);
-            float player_dist = sqrt(dot(vec2(x_buffer, y_buffer), vec2(x_buffer, y_buffer)));
-            return MDP_BASE_REWARD * (1 - min(std::pow(2, player_dist / 300.f) - 1, (double) 1)) * max(min((player_dist_old - player_dist) / 100.f, 1.f), -1.f);
-        }
-    }
+void scale_boss_planner_budget(float factor) {
+    mcts_boss_planner.budget_us = min(max(mcts_boss_planner.budget_us * factor, MCTS_MIN_BUDGET_US), MCTS_MAX_BUDGET_US);
+    printf("Boss planner: MCTS budget %.0f us per frame\n", mcts_boss_planner.budget_us);
 }
 
-
 void summon_boulder_helper(RenderSystem* renderer) {
     float x_pos = uniform_dist(rng) * (window_width_px - 120) + 60;
     float x_speed = 50 + 100 * uniform_dist(rng);
@@ -0,0 +1,327 @@
+// internal
+#include "frame_capture.hpp"
+
+// stlib
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+static float ms_since(Clock::time_point start)
+{
+	return (float)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.f;
+}
+
+static bool make_directory(const std::string &path)
+{
+#ifdef _WIN32
+	return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+	return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+static uint32_t crc_table[256];
+
+static uint32_t crc32(uint32_t crc, const unsigned char *data, size_t size)
+{
+	if (!crc_table[1]) {
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+				c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			crc_table[n] = c;
+		}
+	}
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+		crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void put_u32(std::vector<unsigned char> &out, uint32_t value)
+{
+	out.push_back((unsigned char)(value >> 24));
+	out.push_back((unsigned char)(value >> 16));
+	out.push_back((unsigned char)(value >> 8));
+	out.push_back((unsigned char)value);
+}
+
+// Length, type, data and the CRC of type and data
+static void write_chunk(FILE *file, const char *type, const unsigned char *data, size_t size)
+{
+	std::vector<unsigned char> header;
+	put_u32(header, (uint32_t)size);
+	header.insert(header.end(), type, type + 4);
+	uint32_t crc = crc32(0, header.data() + 4, 4);
+	crc = crc32(crc, data, size);
+	std::vector<unsigned char> footer;
+	put_u32(footer, crc);
+	fwrite(header.data(), 1, header.size(), file);
+	fwrite(data, 1, size, file);
+	fwrite(footer.data(), 1, footer.size(), file);
+}
+
+FrameCapture::~FrameCapture()
+{
+	// stop() needs the GL context, without it whatever was already handed over is still written
+	if (encoder.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		frame_queued.notify_one();
+		encoder.join();
+	}
+}
+
+void FrameCapture::start(const std::string &directory, CAPTURE_FORMAT format)
+{
+	assert(!recording);
+	if (!make_directory(directory)) {
+		fprintf(stderr, "Failed to create %s, not recording\n", directory.c_str());
+		return;
+	}
+	char stamp[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+	prefix = directory + "/capture_" + stamp + "_";
+
+	this->format = format;
+	for (Slot &slot : slots) {
+		slot = Slot();
+		glGenBuffers(1, &slot.buffer);
+	}
+	gl_has_errors();
+	next_slot = 0;
+	frame_count = 0;
+	dropped_count = 0;
+	written_count = 0;
+	total_ms = 0;
+	max_ms = 0;
+	stopping = false;
+	encoder = std::thread(&FrameCapture::encode, this);
+	recording = true;
+	printf("Recording to %s*\n", prefix.c_str());
+}
+
+void FrameCapture::capture(GLuint framebuffer, ivec2 size)
+{
+	assert(recording);
+	Clock::time_point start = Clock::now();
+
+	Slot &slot = slots[next_slot];
+	next_slot = (next_slot + 1) % FRAME_CAPTURE_BUFFERS;
+	if (slot.fence)
+		retire(slot);
+
+	const GLsizeiptr bytes = (GLsizeiptr)size.x * size.y * 4;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	if (slot.capacity != bytes) {
+		// only when the internal resolution changes
+		glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+		slot.capacity = bytes;
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	// with a pack buffer bound this only queues the copy and returns
+	glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.size = size;
+	slot.frame = frame_count++;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	gl_has_errors();
+
+	const float spent_ms = ms_since(start);
+	total_ms += spent_ms;
+	max_ms = max(max_ms, spent_ms);
+}
+
+void FrameCapture::retire(Slot &slot)
+{
+	// issued FRAME_CAPTURE_BUFFERS frames ago, this practically never waits
+	GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+	if (result == GL_WAIT_FAILED)
+		fprintf(stderr, "Waiting on the frame capture fence failed\n");
+	glDeleteSync(slot.fence);
+	slot.fence = nullptr;
+
+	Frame frame;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.size() >= FRAME_CAPTURE_QUEUE) {
+			dropped_count++;
+			return;
+		}
+		if (!spare.empty()) {
+			frame.pixels = std::move(spare.back());
+			spare.pop_back();
+		}
+	}
+	frame.size = slot.size;
+	frame.frame = slot.frame;
+	frame.pixels.resize((size_t)slot.capacity);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, GL_MAP_READ_BIT);
+	if (!mapped) {
+		fprintf(stderr, "Failed to map frame %u for capture\n", slot.frame);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		dropped_count++;
+		return;
+	}
+	memcpy(frame.pixels.data(), mapped, frame.pixels.size());
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(std::move(frame));
+	}
+	frame_queued.notify_one();
+}
+
+void FrameCapture::stop()
+{
+	if (!recording)
+		return;
+	Clock::time_point start = Clock::now();
+	// oldest first, so the files come out in order
+	for (uint i = 0; i < FRAME_CAPTURE_BUFFERS; i++) {
+		Slot &slot = slots[(next_slot + i) % FRAME_CAPTURE_BUFFERS];
+		if (slot.fence)
+			retire(slot);
+	}
+	total_ms += ms_since(start);
+	for (Slot &slot : slots)
+		glDeleteBuffers(1, &slot.buffer);
+	gl_has_errors();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	frame_queued.notify_one();
+	encoder.join();
+	recording = false;
+	spare.clear();
+
+	printf("Recorded %u of %u frames to %s*, %u dropped, %.3f ms per frame on the render thread (%.3f ms at most)\n",
+		   written_count, frame_count, prefix.c_str(), dropped_count, frame_count ? total_ms / frame_count : 0.f, max_ms);
+}
+
+void FrameCapture::encode()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		frame_queued.wait(lock, [this] { return stopping || !queue.empty(); });
+		if (queue.empty())
+			return;
+		Frame frame = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+
+		const bool written = write(frame);
+
+		lock.lock();
+		if (written)
+			written_count++;
+		spare.push_back(std::move(frame.pixels));
+	}
+}
+
+bool FrameCapture::write(const Frame &frame)
+{
+	char name[64];
+	if (format == CAPTURE_FORMAT::PNG)
+		snprintf(name, sizeof(name), "%05u.png", frame.frame);
+	else
+		snprintf(name, sizeof(name), "%05u_%dx%d.rgba", frame.frame, frame.size.x, frame.size.y);
+	const std::string path = prefix + name;
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		fprintf(stderr, "Failed to open %s\n", path.c_str());
+		return false;
+	}
+
+	if (format == CAPTURE_FORMAT::PNG) {
+		write_png(file, frame);
+	} else {
+		// files are top row first like every image format, GL reads bottom row first
+		const size_t row_size = (size_t)frame.size.x * 4;
+		for (int y = frame.size.y - 1; y >= 0; y--)
+			fwrite(frame.pixels.data() + y * row_size, 1, row_size, file);
+	}
+	const bool failed = ferror(file) != 0;
+	if (failed)
+		fprintf(stderr, "Failed to write %s\n", path.c_str());
+	fclose(file);
+	return !failed;
+}
+
+// 8 bit RGBA without filtering and with stored deflate blocks. Several times the size of a compressed
+// PNG but nearly as fast to write as the raw pixels, so the encoder keeps up with the game
+void FrameCapture::write_png(FILE *file, const Frame &frame)
+{
+	static const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	fwrite(signature, 1, sizeof(signature), file);
+
+	std::vector<unsigned char> header;
+	put_u32(header, (uint32_t)frame.size.x);
+	put_u32(header, (uint32_t)frame.size.y);
+	// bit depth, color type RGBA, compression, filter, interlace
+	const unsigned char format_bytes[] = { 8, 6, 0, 0, 0 };
+	header.insert(header.end(), format_bytes, format_bytes + sizeof(format_bytes));
+	write_chunk(file, "IHDR", header.data(), header.size());
+
+	// every row starts with its filter type, 0 for none
+	const size_t row_size = (size_t)frame.size.x * 4;
+	scanlines.resize((row_size + 1) * frame.size.y);
+	for (int y = 0; y < frame.size.y; y++) {
+		unsigned char *line = scanlines.data() + y * (row_size + 1);
+		line[0] = 0;
+		memcpy(line + 1, frame.pixels.data() + (frame.size.y - 1 - y) * row_size, row_size);
+	}
+
+	const size_t block_size = 65535;
+	const size_t block_count = (scanlines.size() + block_size - 1) / block_size;
+	encoded.clear();
+	encoded.reserve(2 + scanlines.size() + block_count * 5 + 4);
+	// zlib header, deflate with a 32K window and no preset dictionary
+	encoded.push_back(0x78);
+	encoded.push_back(0x01);
+	for (size_t offset = 0; offset < scanlines.size(); offset += block_size) {
+		const size_t length = std::min(block_size, scanlines.size() - offset);
+		const bool last = offset + length == scanlines.size();
+		const unsigned char block_header[] = { (unsigned char)(last ? 1 : 0), (unsigned char)length, (unsigned char)(length >> 8),
+											   (unsigned char)~length, (unsigned char)(~length >> 8) };
+		encoded.insert(encoded.end(), block_header, block_header + sizeof(block_header));
+		encoded.insert(encoded.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+	}
+
+	// Adler-32, the sums cannot overflow in 5552 bytes so the modulo is only taken once per run
+	uint32_t adler_a = 1, adler_b = 0;
+	for (size_t offset = 0; offset < scanlines.size(); offset += 5552) {
+		const size_t end = std::min(offset + 5552, scanlines.size());
+		for (size_t i = offset; i < end; i++) {
+			adler_a += scanlines[i];
+			adler_b += adler_a;
+		}
+		adler_a %= 65521;
+		adler_b %= 65521;
+	}
+	put_u32(encoded, (adler_b << 16) | adler_a);
+
+	write_chunk(file, "IDAT", encoded.data(), encoded.size());
+	write_chunk(file, "IEND", nullptr, 0);
+}
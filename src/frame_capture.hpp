@@ -0,0 +1,93 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <array>
+#include <cstdio>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads in flight, a read is mapped this many frames after it was issued
+const uint FRAME_CAPTURE_BUFFERS = 3;
+// Frames waiting for the encoder at most, past that new ones are dropped rather than holding up the game
+const uint FRAME_CAPTURE_QUEUE = 8;
+
+enum class CAPTURE_FORMAT
+{
+	// uncompressed, readable by anything
+	PNG = 0,
+	// the bare RGBA rows top to bottom, the size is in the file name
+	RAW = PNG + 1
+};
+
+// Records a render target to numbered image files. Every frame is read into the next pixel buffer
+// object of a ring, which the GPU fills without the CPU waiting on it, and only mapped once the ring
+// comes back around to it. The pixels are then copied out and handed to a thread of its own that
+// encodes and writes them, so the render thread only ever pays for issuing the read and one copy.
+class FrameCapture
+{
+public:
+	~FrameCapture();
+
+	// All calls but is_recording need the GL context current. Files go into the directory, named
+	// after the time the recording started
+	void start(const std::string &directory, CAPTURE_FORMAT format);
+	// Reads color attachment 0 of the framebuffer and hands the read issued FRAME_CAPTURE_BUFFERS
+	// frames ago to the encoder
+	void capture(GLuint framebuffer, ivec2 size);
+	// Hands over the reads still in flight, waits for the encoder and reports how it went
+	void stop();
+	bool is_recording() const { return recording; }
+
+private:
+	struct Slot
+	{
+		GLuint buffer = 0;
+		GLsizeiptr capacity = 0;
+		GLsync fence = nullptr;
+		ivec2 size = { 0, 0 };
+		uint frame = 0;
+	};
+	struct Frame
+	{
+		// bottom row first, as GL reads them
+		std::vector<unsigned char> pixels;
+		ivec2 size;
+		uint frame;
+	};
+
+	// Maps a finished read and queues its pixels for the encoder
+	void retire(Slot &slot);
+	void encode();
+	bool write(const Frame &frame);
+	void write_png(FILE *file, const Frame &frame);
+
+	bool recording = false;
+	CAPTURE_FORMAT format = CAPTURE_FORMAT::PNG;
+	std::string prefix;
+	std::array<Slot, FRAME_CAPTURE_BUFFERS> slots;
+	uint next_slot = 0;
+	uint frame_count = 0;
+	uint dropped_count = 0;
+	// time capture spent on the render thread
+	float total_ms = 0;
+	float max_ms = 0;
+
+	std::thread encoder;
+	std::mutex mutex;
+	std::condition_variable frame_queued;
+	std::deque<Frame> queue;
+	// buffers the encoder is done with, reused so recording does not allocate every frame
+	std::vector<std::vector<unsigned char>> spare;
+	bool stopping = false;
+	uint written_count = 0;
+	// only touched by the encoder thread
+	std::vector<unsigned char> scanlines;
+	std::vector<unsigned char> encoded;
+};
@@ -0,0 +1,31 @@
+// internal
+#include "frame_graph.hpp"
+
+void FrameGraph::add_pass(const char *name, RENDER_TARGET target, std::function<bool()> active, std::function<void()> execute)
+{
+	passes.push_back({ name, target, std::move(active), std::move(execute) });
+}
+
+void FrameGraph::execute()
+{
+	assert(bind_target);
+	executed_count = 0;
+	skipped_count = 0;
+	bool is_bound = false;
+	RENDER_TARGET bound_target = RENDER_TARGET::SCENE;
+	for (const Pass &pass : passes) {
+		if (pass.active && !pass.active()) {
+			skipped_count++;
+			continue;
+		}
+		if (!is_bound || pass.target != bound_target) {
+			bind_target(pass.target);
+			is_bound = true;
+			bound_target = pass.target;
+		}
+		pass.execute();
+		if (gl_has_errors())
+			fprintf(stderr, " in the %s pass\n", pass.name);
+		executed_count++;
+	}
+}
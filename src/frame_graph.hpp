@@ -0,0 +1,48 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <functional>
+#include <vector>
+
+// Where a pass draws
+enum class RENDER_TARGET
+{
+	// offscreen texture the scene is composed in, see RenderSystem::initScreenTexture
+	SCENE = 0,
+	// premultiplied dialogue layer, composed over the scene by the post-process
+	DIALOGUE = SCENE + 1,
+	// the window's backbuffer, letterboxed to the game's aspect ratio
+	WINDOW = DIALOGUE + 1
+};
+
+// The passes making up a frame. They run in the order they were added, a pass whose active check
+// says it has nothing to do this frame is skipped, and a target is only bound when the pass drawing
+// into it differs from the previous one's.
+class FrameGraph
+{
+public:
+	struct Pass
+	{
+		const char *name;
+		RENDER_TARGET target;
+		// nullptr for passes that always run
+		std::function<bool()> active;
+		std::function<void()> execute;
+	};
+
+	// Binds the target and sets its viewport
+	std::function<void(RENDER_TARGET)> bind_target;
+
+	void add_pass(const char *name, RENDER_TARGET target, std::function<bool()> active, std::function<void()> execute);
+	void execute();
+
+	// stats for the last frame
+	uint executed_count = 0;
+	uint skipped_count = 0;
+
+private:
+	std::vector<Pass> passes;
+};
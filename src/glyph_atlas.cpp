@@ -0,0 +1,128 @@
+// internal
+#include "glyph_atlas.hpp"
+
+// stlib
+#include <algorithm>
+
+// 5x7 dot font, one byte per row from the top, the lowest 5 bits are the dots from the left
+struct FontGlyph
+{
+	char character;
+	unsigned char rows[7];
+};
+
+static const FontGlyph font[] = {
+	{ ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+	{ '!', { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 } },
+	{ '"', { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+	{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+	{ '\'', { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+	{ '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+	{ ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+	{ '*', { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 } },
+	{ '+', { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } },
+	{ ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+	{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+	{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+	{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+	{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+	{ ';', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 } },
+	{ '<', { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 } },
+	{ '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+	{ '>', { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 } },
+	{ '?', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+	{ 'A', { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+	{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+	{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+	{ 'D', { 0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E } },
+	{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+	{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+	{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+	{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+	{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+	{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+	{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+	{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+	{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+	{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+	{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+	{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+	{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+	{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+	{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+	{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+	{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+	{ '[', { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E } },
+	{ ']', { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E } },
+	{ '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+};
+
+void GlyphAtlas::build(const std::array<const unsigned char*, 10>& digits, const std::array<ivec2, 10>& digit_sizes)
+{
+	int digit_width = 0;
+	for (ivec2 digit_size : digit_sizes) {
+		assert(digit_size.y <= GLYPH_CELL_HEIGHT);
+		digit_width = max(digit_width, digit_size.x);
+	}
+	// digits are monospaced so changing numbers do not shift around, every cell ends in a dot wide gap
+	const int digit_cell_width = digit_width + GLYPH_DOT_SIZE;
+	const int font_cell_width = 6 * GLYPH_DOT_SIZE;
+	const int slot_width = max(digit_cell_width, font_cell_width) + GLYPH_PADDING;
+	const int slot_height = GLYPH_CELL_HEIGHT + GLYPH_PADDING;
+	const int rows = (glyph_count + GLYPH_COLUMNS - 1) / GLYPH_COLUMNS;
+	size = { GLYPH_COLUMNS * slot_width + GLYPH_PADDING, rows * slot_height + GLYPH_PADDING };
+	pixels.assign((size_t)size.x * size.y * 4, 0);
+
+	std::array<bool, glyph_count> defined = {};
+	// top left corner of the glyph's cell, and its uv rect
+	auto place = [&](int index, int cell_width) {
+		ivec2 position = { GLYPH_PADDING + (index % GLYPH_COLUMNS) * slot_width, GLYPH_PADDING + (index / GLYPH_COLUMNS) * slot_height };
+		glyphs[index].uv_rect = vec4(vec2(position) / vec2(size), vec2(cell_width, GLYPH_CELL_HEIGHT) / vec2(size));
+		glyphs[index].aspect = cell_width / (float)GLYPH_CELL_HEIGHT;
+		defined[index] = true;
+		return position;
+	};
+
+	for (const FontGlyph &glyph : font) {
+		const ivec2 position = place(glyph.character - GLYPH_FIRST, font_cell_width);
+		const int top = position.y + (GLYPH_CELL_HEIGHT - 7 * GLYPH_DOT_SIZE) / 2;
+		for (int y = 0; y < 7 * GLYPH_DOT_SIZE; y++) {
+			for (int x = 0; x < 5 * GLYPH_DOT_SIZE; x++) {
+				if (!(glyph.rows[y / GLYPH_DOT_SIZE] & (0x10 >> (x / GLYPH_DOT_SIZE))))
+					continue;
+				unsigned char *pixel = &pixels[((size_t)(top + y) * size.x + position.x + x) * 4];
+				std::fill(pixel, pixel + 4, 255);
+			}
+		}
+	}
+
+	for (int d = 0; d < 10; d++) {
+		const ivec2 position = place('0' + d - GLYPH_FIRST, digit_cell_width);
+		const ivec2 digit_size = digit_sizes[d];
+		const ivec2 corner = position + ivec2((digit_width - digit_size.x) / 2, (GLYPH_CELL_HEIGHT - digit_size.y) / 2);
+		for (int row = 0; row < digit_size.y; row++)
+			std::copy(digits[d] + (size_t)row * digit_size.x * 4, digits[d] + (size_t)(row + 1) * digit_size.x * 4,
+					  pixels.begin() + ((size_t)(corner.y + row) * size.x + corner.x) * 4);
+	}
+
+	// lower case letters share the upper case cells, anything else left is drawn as '?'
+	for (int index = 0; index < glyph_count; index++) {
+		if (defined[index])
+			continue;
+		const char c = (char)(GLYPH_FIRST + index);
+		const char fallback = c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : '?';
+		glyphs[index] = glyphs[fallback - GLYPH_FIRST];
+	}
+}
+
+const Glyph& find_glyph(const std::array<Glyph, glyph_count>& glyphs, char c)
+{
+	if (c < GLYPH_FIRST || c > GLYPH_LAST)
+		c = '?';
+	return glyphs[c - GLYPH_FIRST];
+}
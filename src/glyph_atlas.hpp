@@ -0,0 +1,45 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <array>
+#include <vector>
+
+// Characters the atlas has glyphs for, lower case letters are drawn upper case
+const char GLYPH_FIRST = ' ';
+const char GLYPH_LAST = '~';
+const int glyph_count = GLYPH_LAST - GLYPH_FIRST + 1;
+// Height of every glyph cell, the height of the score digit art
+const int GLYPH_CELL_HEIGHT = 41;
+// Side of one dot of the built in font, in atlas pixels
+const int GLYPH_DOT_SIZE = 5;
+// Transparent gap between cells so filtering never picks up a neighbour
+const int GLYPH_PADDING = 2;
+const int GLYPH_COLUMNS = 16;
+
+struct Glyph
+{
+	// where the glyph's cell is in the atlas image, x, y, width, height in uv
+	vec4 uv_rect;
+	// cell width over height, the advance of the glyph at a height of 1
+	float aspect;
+};
+
+// One RGBA image holding a glyph for every character: the score digit art for 0 to 9, so numbers
+// look the same wherever they are shown, and a built in 5x7 dot font for everything else.
+// Cells include the gap to the next glyph, a string is drawn by placing its cells side by side.
+class GlyphAtlas
+{
+public:
+	// digits holds the RGBA pixels of the 0 to 9 textures, in order
+	void build(const std::array<const unsigned char*, 10>& digits, const std::array<ivec2, 10>& digit_sizes);
+
+	ivec2 size = { 0, 0 };
+	std::vector<unsigned char> pixels;
+	std::array<Glyph, glyph_count> glyphs;
+};
+
+// The glyph a character is drawn with, '?' for those the atlas has none for
+const Glyph& find_glyph(const std::array<Glyph, glyph_count>& glyphs, char c);
@@ -6,6 +6,7 @@
 #include <chrono>
 
 // internal
+#include "animation_system.hpp"
 #include "physics_system.hpp"
 #include "render_system.hpp"
 #include "world_system.hpp"
@@ -18,6 +19,7 @@ int main()
 	WorldSystem world_system;
 	RenderSystem render_system;
 	PhysicsSystem physics_system;
+	AnimationSystem animation_system;
 	
 	// Initializing window
 	GLFWwindow* window = world_system.create_window();
@@ -31,6 +33,8 @@ int main()
 	// initialize the main systems
 	render_system.init(window);
 	world_system.init(&render_system);
+	// from here on only the render thread touches GL
+	render_system.startRenderThread();
 	
 	// variable timestep loop
 	auto t = Clock::now();
@@ -40,17 +44,25 @@ int main()
 		// Calculating elapsed times in milliseconds from the previous iteration
         auto now = Clock::now();
 		
-        if (!world_system.pause && !world_system.isTitleScreen) {
-            float elapsed_ms =
-                    min((float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000, 50.0f);
-            world_system.step(elapsed_ms);
-			physics_system.step(elapsed_ms, world_system.dialogue_screen_active);
-            world_system.handle_collisions();
+        float elapsed_ms =
+                min((float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000, 50.0f);
+        if (!world_system.pause) {
+            // one time animations only play out in game, the looping ones also on the menus and dialogues
+            animation_system.step(elapsed_ms, !world_system.isTitleScreen && !world_system.dialogue_screen_active);
+            if (!world_system.isTitleScreen) {
+                world_system.step(elapsed_ms);
+                physics_system.step(elapsed_ms, world_system.dialogue_screen_active);
+                world_system.handle_collisions();
+            }
+            animation_system.resolve();
         }
         t = now;
 
-		render_system.draw(world_system.pause, world_system.debug, world_system.dialogue_screen_active);
+		// drawn on the render thread while the next frame is simulated
+		render_system.capture(world_system.pause, world_system.debug, world_system.dialogue_screen_active);
+		render_system.publish();
 	}
+	render_system.stopRenderThread();
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,152 @@
+// internal
+#include "perception.hpp"
+#include "physics_system.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstring>
+
+void Perception::begin_frame(const SpatialGrid* grid_arg, Entity player_hero)
+{
+	grid = grid_arg;
+	if (grid->get_generation() != grid_generation) {
+		grid_generation = grid->get_generation();
+		list_cache.clear();
+		sight_cache.clear();
+	}
+	player_pos = registry.motions.get(player_hero).position;
+}
+
+// FNV-1a over the bits of the query
+size_t Perception::QueryHash::operator()(const Query& query) const
+{
+	// adding zero turns -0 into 0, which compare equal and so must hash the same
+	const vec2 points[2] = { query.a + 0.f, query.b + 0.f };
+	uint32_t words[7];
+	memcpy(words, points, sizeof(points));
+	words[4] = (uint32_t) query.kind;
+	words[5] = query.category_mask;
+	words[6] = query.k;
+	uint32_t hash = 2166136261u;
+	for (uint32_t word: words) {
+		hash ^= word;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Distance from a point to an entry's bounds, 0 if inside
+static float distance_to(const SpatialGrid::Entry& entry, vec2 pos)
+{
+	vec2 outside = max(max(entry.min - pos, pos - entry.max), vec2(0));
+	return length(outside);
+}
+
+const std::vector<Entity>& Perception::within_radius(vec2 center, float radius, uint category_mask)
+{
+	Query query = { QUERY_KIND::RADIUS, center, vec2(radius, 0), category_mask, 0 };
+	auto cached = list_cache.find(query);
+	if (cached != list_cache.end())
+		return cached->second;
+
+	const std::vector<SpatialGrid::Entry>& entries = grid->get_entries();
+	candidates.clear();
+	grid->query_box(center - radius, center + radius, category_mask, [&](uint index) {
+		float dist = distance_to(entries[index], center);
+		if (dist <= radius)
+			candidates.push_back({ dist, index });
+	});
+	std::sort(candidates.begin(), candidates.end());
+
+	std::vector<Entity>& result = list_cache[query];
+	for (const std::pair<float, uint>& candidate: candidates) {
+		// the index is from the last physics step, skip anything removed since
+		Entity entity = entries[candidate.second].entity;
+		if (registry.motions.has(entity))
+			result.push_back(entity);
+	}
+	return result;
+}
+
+const std::vector<Entity>& Perception::nearest(vec2 pos, uint k, uint category_mask)
+{
+	Query query = { QUERY_KIND::NEAREST, pos, vec2(0), category_mask, k };
+	auto cached = list_cache.find(query);
+	if (cached != list_cache.end())
+		return cached->second;
+
+	const std::vector<SpatialGrid::Entry>& entries = grid->get_entries();
+	auto gather = [&](float radius) {
+		candidates.clear();
+		grid->query_box(pos - radius, pos + radius, category_mask, [&](uint index) {
+			if (registry.motions.has(entries[index].entity))
+				candidates.push_back({ distance_to(entries[index], pos), index });
+		});
+		std::sort(candidates.begin(), candidates.end());
+	};
+
+	// grow the search box until it is guaranteed to hold the k closest
+	const float max_radius = SPATIAL_GRID_CELL_SIZE * (SPATIAL_GRID_COLUMNS + SPATIAL_GRID_ROWS);
+	float radius = SPATIAL_GRID_CELL_SIZE;
+	while (true) {
+		gather(radius);
+		if (k > 0 && candidates.size() >= k) {
+			// a box of half size radius only guarantees everything within radius was seen
+			float kth = candidates[k - 1].first;
+			if (kth > radius)
+				gather(kth);
+			break;
+		}
+		if (radius >= max_radius)
+			break;
+		radius *= 2;
+	}
+
+	std::vector<Entity>& result = list_cache[query];
+	for (uint i = 0; i < candidates.size() && i < k; i++)
+		result.push_back(entries[candidates[i].second].entity);
+	return result;
+}
+
+bool Perception::line_of_sight(vec2 from, vec2 to, uint blocker_mask)
+{
+	Query query = { QUERY_KIND::SIGHT, from, to, blocker_mask, 0 };
+	auto cached = sight_cache.find(query);
+	if (cached != sight_cache.end())
+		return cached->second;
+
+	const std::vector<SpatialGrid::Entry>& entries = grid->get_entries();
+	bool blocked = false;
+	grid->query_box(min(from, to), max(from, to), blocker_mask, [&](uint index) {
+		const SpatialGrid::Entry& entry = entries[index];
+		// the entry bounds are padded for rotation, the test is against the collider itself
+		if (blocked || !registry.motions.has(entry.entity))
+			return;
+		const Motion& motion = registry.motions.get(entry.entity);
+		blocked = segment_intersects_box(from, to, motion.position, abs(motion.scale) / 2.f);
+	});
+	sight_cache[query] = !blocked;
+	return !blocked;
+}
+
+const SpatialGrid::Entry* Perception::ground_below(vec2 position, vec2 scale)
+{
+	vec2 half = abs(scale) / 2.f;
+	float feet = position.y + half.y;
+	const std::vector<SpatialGrid::Entry>& entries = grid->get_entries();
+	const SpatialGrid::Entry* ground = nullptr;
+	float best_offset = 0;
+	grid->query_box({ position.x - half.x, feet - PERCEPTION_GROUND_TOLERANCE }, { position.x + half.x, feet + PERCEPTION_GROUND_TOLERANCE }, SPATIAL_BLOCK, [&](uint index) {
+		const SpatialGrid::Entry& entry = entries[index];
+		if (abs(entry.min.y - feet) > PERCEPTION_GROUND_TOLERANCE || !registry.motions.has(entry.entity))
+			return;
+		// prefer the block most of the agent is over
+		float offset = abs((entry.min.x + entry.max.x) / 2.f - position.x);
+		if (!ground || offset < best_offset) {
+			ground = &entry;
+			best_offset = offset;
+		}
+	});
+	return ground;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "spatial_grid.hpp"
+
+// stlib
+#include <unordered_map>
+#include <vector>
+
+// How far below its feet an agent may be from a block top and still count as standing on it
+const float PERCEPTION_GROUND_TOLERANCE = 2.f;
+
+// What the enemies can know about their surroundings. Queries go through the physics spatial index
+// and their results are cached until the index is rebuilt, keyed on the exact query, so asking the
+// same thing again in a frame (the boss planner does every frame of a decision) is a lookup.
+// Not re-entrant: do not query from inside another query.
+class Perception
+{
+public:
+	// Call once per frame before any query
+	void begin_frame(const SpatialGrid* grid, Entity player_hero);
+
+	vec2 player_position() const { return player_pos; }
+
+	// Entities of the given categories within radius of center, closest first
+	const std::vector<Entity>& within_radius(vec2 center, float radius, uint category_mask);
+	// Up to k entities of the given categories closest to pos, closest first
+	const std::vector<Entity>& nearest(vec2 pos, uint k, uint category_mask);
+	// Whether nothing of the blocking categories lies on the segment between the two points
+	bool line_of_sight(vec2 from, vec2 to, uint blocker_mask = SPATIAL_BLOCK);
+	// The block an agent with the given position and size is standing on, nullptr if none
+	const SpatialGrid::Entry* ground_below(vec2 position, vec2 scale);
+
+private:
+	enum class QUERY_KIND : uint { RADIUS, NEAREST, SIGHT };
+	// a and b are the center and radius, the position, or the two ends of the segment
+	struct Query
+	{
+		QUERY_KIND kind;
+		vec2 a, b;
+		uint category_mask;
+		uint k;
+		bool operator==(const Query& other) const
+		{
+			return kind == other.kind && a == other.a && b == other.b && category_mask == other.category_mask && k == other.k;
+		}
+	};
+	struct QueryHash
+	{
+		size_t operator()(const Query& query) const;
+	};
+
+	const SpatialGrid* grid = nullptr;
+	uint grid_generation = 0;
+	vec2 player_pos = { 0, 0 };
+
+	std::unordered_map<Query, std::vector<Entity>, QueryHash> list_cache;
+	std::unordered_map<Query, bool, QueryHash> sight_cache;
+	// scratch for sorting candidates by distance
+	std::vector<std::pair<float, uint>> candidates;
+};
@@ -5,6 +5,8 @@
 
 const float COLLISION_THRESHOLD = 0.0f;
 
+SpatialGrid PhysicsSystem::spatial_index;
+
 void PhysicsSystem::init(RenderSystem* renderer_arg) {
     this->renderer = renderer_arg;
 }
@@ -32,7 +34,7 @@ bool check_collision_conditions(Entity entity_i, Entity entity_j) {
         }
     } else if (registry.blocks.has(entity_i) && (registry.solids.has(entity_j) || registry.projectiles.has(entity_j))) {
         return true;
-    } else if (registry.parallaxBackgrounds.has(entity_i) || registry.blocks.has(entity_i)) {
+    } else if (registry.lavas.has(entity_i) || registry.blocks.has(entity_i)) {
         if (registry.bullets.has(entity_j) ||
             registry.rockets.has(entity_j) ||
             registry.grenades.has(entity_j) ||
@@ -88,6 +90,29 @@ bool check_inside(vec2 p1, vec2 q1, vec2 p2, vec2 q2) {
     return false;
 }
 
+bool segment_intersects_box(vec2 p, vec2 q, vec2 center, vec2 half_size) {
+    // slab test, clipping the segment's parameter range against both axes
+    vec2 d = q - p;
+    float t_min = 0.f;
+    float t_max = 1.f;
+    for (int axis = 0; axis < 2; axis++) {
+        float lo = center[axis] - half_size[axis];
+        float hi = center[axis] + half_size[axis];
+        if (d[axis] == 0) {
+            if (p[axis] < lo || p[axis] > hi)
+                return false;
+            continue;
+        }
+        float t1 = (lo - p[axis]) / d[axis];
+        float t2 = (hi - p[axis]) / d[axis];
+        t_min = max(t_min, min(t1, t2));
+        t_max = min(t_max, max(t1, t2));
+        if (t_min > t_max)
+            return false;
+    }
+    return true;
+}
+
 bool precise_collision(const Entity& entity1, const Entity& entity2) {
     Motion& motion1 = registry.motions.get(entity1);
     Motion& motion2 = registry.motions.get(entity2);
@@ -171,15 +196,16 @@ void PhysicsSystem::step(float elapsed_ms, int dialogue)
         }
     }
 
-    // Check for collisions between all entities with meshes
-    for (uint i = 0; i < registry.collisionMeshPtrs.size(); i++) {
-        for (uint j = i + 1; j < registry.collisionMeshPtrs.size(); j++) {
-            Entity entity_i = registry.collisionMeshPtrs.entities[i];
-            Entity entity_j = registry.collisionMeshPtrs.entities[j];            
-            if ((check_collision_conditions(entity_i, entity_j) || check_collision_conditions(entity_j, entity_i)) && PhysicsSystem::collides(entity_i, entity_j)) {
-                registry.collisions.emplace_with_duplicates(entity_i, entity_j);
-                registry.collisions.emplace_with_duplicates(entity_j, entity_i);
-            }
+    // Check for collisions between entities with meshes whose bounds overlap in the grid
+    spatial_index.build();
+    spatial_index.overlapping_pairs(candidate_pairs);
+    const std::vector<SpatialGrid::Entry>& entries = spatial_index.get_entries();
+    for (const std::pair<uint, uint>& pair: candidate_pairs) {
+        Entity entity_i = entries[pair.first].entity;
+        Entity entity_j = entries[pair.second].entity;
+        if ((check_collision_conditions(entity_i, entity_j) || check_collision_conditions(entity_j, entity_i)) && PhysicsSystem::collides(entity_i, entity_j)) {
+            registry.collisions.emplace_with_duplicates(entity_i, entity_j);
+            registry.collisions.emplace_with_duplicates(entity_j, entity_i);
         }
     }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
 #include "render_system.hpp"
+#include "spatial_grid.hpp"
 
 const float GRAVITY_ACCELERATION_FACTOR = 10.0 / 17.5;
 
@@ -19,6 +20,13 @@ public:
 	PhysicsSystem()
 	{
 	}
+
+	// Broadphase index over all collidable entities as of the last step, also used for AI perception
+	static SpatialGrid spatial_index;
 private:
 	RenderSystem* renderer;
-};
\ No newline at end of file
+	std::vector<std::pair<uint, uint>> candidate_pairs;
+};
+
+// Whether the segment p -> q touches the axis aligned box at center with the given half size
+bool segment_intersects_box(vec2 p, vec2 q, vec2 center, vec2 half_size);
\ No newline at end of file
@@ -5,12 +5,57 @@
 
 #include "tiny_ecs_registry.hpp"
 
-void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, bool pause, bool is_debug)
+// stlib
+#include <algorithm>
+#include <cstddef>
+
+// Sprite effects that sample a sprite sheet cell
+static bool is_sheet_effect(EFFECT_ASSET_ID effect)
+{
+	switch (effect) {
+		case EFFECT_ASSET_ID::ANIMATED:
+		case EFFECT_ASSET_ID::HERO:
+		case EFFECT_ASSET_ID::EXPLOSION:
+		case EFFECT_ASSET_ID::WATER_BALL:
+		case EFFECT_ASSET_ID::FIRE_ENEMY:
+		case EFFECT_ASSET_ID::GHOUL:
+		case EFFECT_ASSET_ID::SPITTER_ENEMY:
+		case EFFECT_ASSET_ID::SPITTER_ENEMY_BULLET:
+		case EFFECT_ASSET_ID::FOLLOWING_ENEMY:
+		case EFFECT_ASSET_ID::LAVA_PILLAR:
+		case EFFECT_ASSET_ID::BOSS:
+		case EFFECT_ASSET_ID::GRENADE_ORB:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Sprite effects that sample the whole texture
+static bool is_plain_textured_effect(EFFECT_ASSET_ID effect)
+{
+	return effect == EFFECT_ASSET_ID::TEXTURED || effect == EFFECT_ASSET_ID::BOSS_SWORD_S || effect == EFFECT_ASSET_ID::BOSS_SWORD_L ||
+		   effect == EFFECT_ASSET_ID::HEALTH_BAR;
+}
+
+// Parameters of the sprite shader features, see shaders/sprite_features.glsl
+static vec2 sprite_params(Entity entity)
 {
-    assert(registry.renderRequests.has(entity));
-    const RenderRequest &render_request = registry.renderRequests.get(entity);
+	vec2 params = { 0.f, 1.f };
+	if (registry.players.has(entity) && !registry.deathTimers.has(entity))
+		params.x = registry.players.get(entity).invulnerable_timer;
+	if (registry.healthBar.has(entity)) {
+		params.y = 0.f;
+		if (registry.enemies.has(registry.healthBar.get(entity).owner)) {
+			Enemies &enemy = registry.enemies.get(registry.healthBar.get(entity).owner);
+			params.y = (float)enemy.health / (float)enemy.total_health;
+		}
+	}
+	return params;
+}
 
-	Motion &motion = registry.motions.get(entity);
+static mat3 sprite_transform(const Motion &motion, const RenderRequest &render_request, bool is_debug)
+{
 	// Transformation code, see Rendering and Transformation in the template
 	// specification for more info Incrementally updates transformation matrix,
 	// thus ORDER IS IMPORTANT
@@ -25,428 +70,696 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, bool
 	}
 	transform.rotate(motion.globalAngle);
 	transform.scale((is_debug ? motion.scale : render_request.scale) * flip);
+	return transform.mat;
+}
 
+// Everything drawing the request needs from the registry, debug requests show the hitbox texture
+static RenderItem capture_item(Entity entity, const RenderRequest &render_request, const mat3 &transform, bool is_debug)
+{
+	RenderItem item;
+	item.transform = transform;
+	item.color = registry.colors.has(entity) ? registry.colors.get(entity) : vec3(1);
+	item.uv_rect = vec4(0, 0, 1, 1);
+	if (!is_debug && is_sheet_effect(render_request.used_effect) && registry.animated.has(entity))
+		item.uv_rect = registry.animated.get(entity).frame_rect;
+	item.params = sprite_params(entity);
+	item.texture = render_request.used_texture;
+	if (is_debug) {
+		item.texture = TEXTURE_ASSET_ID::HITBOX;
+	} else if (registry.buttons.has(entity) && registry.buttons.get(entity).clicked) {
+		// pressed texture must be +1 of the unpressed texture
+		item.texture = (TEXTURE_ASSET_ID)((uint)render_request.used_texture + 1);
+	}
+	item.effect = render_request.used_effect;
+	item.geometry = render_request.used_geometry;
+	return item;
+}
 
-	const GLuint used_effect_enum = (GLuint)render_request.used_effect;
-	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
-	const GLuint program = (GLuint)effects[used_effect_enum];
+bool RenderSystem::batchSprite(const RenderItem &item, const mat3 &projection)
+{
+	if (item.geometry != GEOMETRY_BUFFER_ID::SPRITE || !(is_sheet_effect(item.effect) || is_plain_textured_effect(item.effect)))
+		return false;
+
+	const GLuint texture = (GLuint)item.texture;
+	// sprites sharing an atlas page share the draw call
+	GLuint texture_id = texture_atlas_page[texture];
+	if (texture_id != sprite_batch_texture) {
+		flushSprites(projection);
+		sprite_batch_texture = texture_id;
+	}
 
-	// Setting shaders
+	SpriteInstance instance;
+	instance.transform = item.transform;
+	instance.color = item.color;
+	// the item's part of the texture, within the texture's place in its page
+	const vec4 &page = texture_uv_rects[texture];
+	instance.uv_rect = vec4(vec2(page) + vec2(item.uv_rect) * vec2(page.z, page.w), vec2(item.uv_rect.z, item.uv_rect.w) * vec2(page.z, page.w));
+	instance.params = item.params;
+	sprite_instances.push_back(instance);
+	return true;
+}
+
+void RenderSystem::flushSprites(const mat3 &projection)
+{
+	if (sprite_instances.empty())
+		return;
+
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::SPRITE_INSTANCED];
 	glUseProgram(program);
 	gl_has_errors();
 
-	assert(render_request.used_geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
-	const GLuint vbo = vertex_buffers[(GLuint)render_request.used_geometry];
-	const GLuint ibo = index_buffers[(GLuint)render_request.used_geometry];
+	// Per instance data, orphaning the previous storage so the driver does not wait on it
+	glBindVertexArray(sprite_instance_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, sprite_instance_buffer);
+	GLsizeiptr instances_size = sizeof(SpriteInstance) * sprite_instances.size();
+	glBufferData(GL_ARRAY_BUFFER, instances_size, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instances_size, sprite_instances.data());
+	gl_has_errors();
 
-	// Setting vertex and index buffers
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	// Enabling and binding texture to slot 0
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, sprite_batch_texture);
 	gl_has_errors();
 
-	// Input data location as in the vertex buffer
-	if (render_request.used_effect == EFFECT_ASSET_ID::TEXTURED || (uint) render_request.used_effect > (uint) EFFECT_ASSET_ID::ANIMATED)
-	{
-		GLint in_position_loc = glGetAttribLocation(program, "in_position");
-		GLint in_texcoord_loc = glGetAttribLocation(program, "in_texcoord");
-		gl_has_errors();
-		assert(in_texcoord_loc >= 0);
+	glUniformMatrix3fv(effect_locations[(GLuint)EFFECT_ASSET_ID::SPRITE_INSTANCED].projection, 1, GL_FALSE, (float *)&projection);
+	gl_has_errors();
 
-		glEnableVertexAttribArray(in_position_loc);
-		glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE,
-							  sizeof(TexturedVertex), (void *)0);
-		gl_has_errors();
+	GLsizei num_indices = index_counts[(GLuint)GEOMETRY_BUFFER_ID::SPRITE];
+
+	glDrawElementsInstanced(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr, (GLsizei)sprite_instances.size());
+	gl_has_errors();
+
+	resetBoundState();
+
+	sprite_instances.clear();
+}
+
+void RenderSystem::clearStream()
+{
+	stream_vertices.clear();
+	stream_runs.clear();
+}
+
+void RenderSystem::streamQuad(vec2 center, vec2 scale, float angle, TEXTURE_ASSET_ID texture)
+{
+	if (stream_vertices.size() + 6 > STREAM_MAX_VERTICES)
+		return;
+
+	// Same corners and winding as the sprite geometry
+	const vec2 axis_x = vec2(cos(angle), sin(angle)) * (scale.x / 2.f);
+	const vec2 axis_y = vec2(-sin(angle), cos(angle)) * (scale.y / 2.f);
+	TexturedVertex corners[4];
+	corners[0] = { vec3(center - axis_x + axis_y, 0.f), {0.f, 1.f} };
+	corners[1] = { vec3(center + axis_x + axis_y, 0.f), {1.f, 1.f} };
+	corners[2] = { vec3(center + axis_x - axis_y, 0.f), {1.f, 0.f} };
+	corners[3] = { vec3(center - axis_x - axis_y, 0.f), {0.f, 0.f} };
+	for (uint corner : {0, 3, 1, 1, 3, 2})
+		stream_vertices.push_back(corners[corner]);
+
+	if (stream_runs.empty() || stream_runs.back().texture != texture)
+		stream_runs.push_back({ texture, (GLint)stream_vertices.size() - 6, 0 });
+	stream_runs.back().count += 6;
+}
+
+void RenderSystem::streamPolyline(const std::vector<vec2> &points, float width, TEXTURE_ASSET_ID texture)
+{
+	for (size_t i = 1; i < points.size(); i++) {
+		vec2 segment = points[i] - points[i - 1];
+		streamQuad((points[i - 1] + points[i]) / 2.f, { length(segment), width }, atan2(segment.y, segment.x), texture);
+	}
+}
+
+void RenderSystem::flushStream(const mat3 &projection)
+{
+	const std::vector<TexturedVertex> &stream_vertices = frame->stream_vertices;
+	if (stream_vertices.empty())
+		return;
+
+	GLintptr offset = stream_buffer.upload(stream_vertices.data(), sizeof(TexturedVertex) * stream_vertices.size());
+	const GLint first = (GLint)(offset / sizeof(TexturedVertex));
+
+	// Vertices are already in world coordinates
+	const EffectLocations &locations = effect_locations[(GLuint)EFFECT_ASSET_ID::TEXTURED];
+	glUseProgram(effects[(GLuint)EFFECT_ASSET_ID::TEXTURED]);
+	glBindVertexArray(stream_vao);
+	const mat3 identity = mat3(1.f);
+	const vec3 color = vec3(1.f);
+	glUniformMatrix3fv(locations.transform, 1, GL_FALSE, (float *)&identity);
+	glUniformMatrix3fv(locations.projection, 1, GL_FALSE, (float *)&projection);
+	glUniform3fv(locations.fcolor, 1, (float *)&color);
+	// the program is shared with sprite sheets, whatever they left set would apply here too
+	glUniform4f(locations.uv_rect, 0, 0, 1, 1);
+	glUniform2f(locations.params, 0, 1);
+	glActiveTexture(GL_TEXTURE0);
+	gl_has_errors();
+
+	for (const StreamRun &run : frame->stream_runs) {
+		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[(GLuint)run.texture]);
+		glDrawArrays(GL_TRIANGLES, first + run.first, run.count);
+	}
+	gl_has_errors();
+	stream_buffer.fence();
+	resetBoundState();
+}
+
+// Sort key of a request, compared as a plain integer. From the most significant bits:
+// layer (4), depth (8), program (8), texture (8), geometry (4), index in its container (32)
+static uint64_t render_key(RENDER_LAYER layer, int depth, uint program, const RenderItem &item, uint index)
+{
+	assert(depth >= 0 && depth < 256);
+	return (uint64_t)layer << RENDER_KEY_LAYER_SHIFT |
+		   (uint64_t)depth << 52 |
+		   (uint64_t)program << 44 |
+		   (uint64_t)item.texture << 36 |
+		   (uint64_t)item.geometry << 32 |
+		   index;
+}
+
+// LSD radix sort a byte at a time, skipping the bytes every key shares
+static void radix_sort(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch)
+{
+	scratch.resize(keys.size());
+	for (uint shift = 0; shift < 64; shift += 8)
+	{
+		uint offsets[256] = {};
+		for (uint64_t key : keys)
+			offsets[(key >> shift) & 0xFF]++;
+		if (offsets[(keys[0] >> shift) & 0xFF] == keys.size())
+			continue;
+		uint total = 0;
+		for (uint &offset : offsets) {
+			uint count = offset;
+			offset = total;
+			total += count;
+		}
+		for (uint64_t key : keys)
+			scratch[offsets[(key >> shift) & 0xFF]++] = key;
+		keys.swap(scratch);
+	}
+}
 
-		glEnableVertexAttribArray(in_texcoord_loc);
-		glVertexAttribPointer(
-			in_texcoord_loc, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex),
-			(void *)sizeof(
-				vec3)); // note the stride to skip the preceeding vertex position
+// Whether the unit quad under the transform overlaps the view grown by RENDER_CULL_MARGIN.
+// The bounds of a transformed square are its center plus half the absolute value of both axes
+static bool in_view(const mat3 &transform)
+{
+	const vec2 center = vec2(transform[2]);
+	const vec2 half_extent = (abs(vec2(transform[0])) + abs(vec2(transform[1]))) / 2.f;
+	return center.x + half_extent.x >= -RENDER_CULL_MARGIN && center.x - half_extent.x <= window_width_px + RENDER_CULL_MARGIN &&
+		   center.y + half_extent.y >= -RENDER_CULL_MARGIN && center.y - half_extent.y <= window_height_px + RENDER_CULL_MARGIN;
+}
 
-        // does animation if texture has animation and is not DEAD
-		if (registry.animated.has(entity) && !registry.deathTimers.has(entity) && !pause && !is_debug)
+void RenderSystem::capture(bool pause, bool debug, int dialogue)
+{
+	static_assert(texture_count < 256 && effect_count < 256 && geometry_count < 16, "render key fields are too narrow");
+
+	RenderSnapshot &snapshot = snapshots[capture_index];
+	snapshot.items.clear();
+	snapshot.queue.clear();
+	culled_count = 0;
+	auto &requests = registry.renderRequests;
+	for (uint i = 0; i < requests.size(); i++)
+	{
+		const RenderRequest &render_request = requests.components[i];
+		Entity entity = requests.entities[i];
+		if (!render_request.visibility || !registry.motions.has(entity))
+			continue;
+		const mat3 transform = sprite_transform(registry.motions.get(entity), render_request, false);
+		if (!in_view(transform)) {
+			culled_count++;
+			continue;
+		}
+		const RenderItem item = capture_item(entity, render_request, transform, false);
+		snapshot.queue.push_back(render_key(render_request.layer, render_request.depth, effect_programs[(uint)item.effect], item, (uint)snapshot.items.size()));
+		snapshot.items.push_back(item);
+	}
+	auto &texts = registry.texts;
+	for (uint i = 0; i < texts.size(); i++)
+	{
+		Entity entity = texts.entities[i];
+		if (texts.components[i].visibility && registry.motions.has(entity))
+			captureText(snapshot, texts.components[i], registry.motions.get(entity).position);
+	}
+	if (debug) {
+		auto &debug_requests = registry.debugRenderRequests;
+		for (uint i = 0; i < debug_requests.size(); i++)
 		{
-			AnimationInfo &info = registry.animated.get(entity);
-			GLint frame_loc = glGetUniformLocation(program, "frame");
-            if (info.oneTimeState != -1) {
-                int count = (int)floor(info.oneTimer * ANIMATION_SPEED_FACTOR);
-                if (count < info.stateFrameLength[info.oneTimeState]) {
-                    glUniform2f(frame_loc, count % info.stateFrameLength[info.oneTimeState], info.oneTimeState);
-                } else {
-                    info.oneTimeState = -1;
-					info.oneTimer = 0;
-                }
-            } else {
-                glUniform2f(frame_loc, ((int)floor(glfwGetTime() * ANIMATION_SPEED_FACTOR) % info.stateFrameLength[info.curState]), info.curState);
-            }
-			GLint scale_loc = glGetUniformLocation(program, "scale");
-			glUniform2f(scale_loc, info.stateCycleLength, info.states);
+			Entity entity = debug_requests.entities[i];
+			if (registry.weaponHitBoxes.has(entity) && !registry.weaponHitBoxes.get(entity).isActive)
+				continue;
+			const RenderRequest &render_request = registry.renderRequests.get(entity);
+			const mat3 transform = sprite_transform(registry.motions.get(entity), render_request, true);
+			if (!in_view(transform)) {
+				culled_count++;
+				continue;
+			}
+			const RenderItem item = capture_item(entity, render_request, transform, true);
+			snapshot.queue.push_back(render_key(RENDER_LAYER::DEBUG, render_request.depth, effect_programs[(uint)item.effect], item, (uint)snapshot.items.size()));
+			snapshot.items.push_back(item);
 		}
+	}
+	submitted_count = (uint)snapshot.queue.size();
+
+	// copied rather than swapped, the stream is not rebuilt every frame
+	snapshot.stream_vertices = stream_vertices;
+	snapshot.stream_runs = stream_runs;
+
+	snapshot.pause = pause;
+	snapshot.dialogue = dialogue;
+	snapshot.screen_darken_factor = registry.screenStates.get(screen_state_entity).screen_darken_factor;
+	snapshot.parallax_visible = parallax_visible;
+	snapshot.parallax_time = parallax_time_ms / 1000.f;
+	snapshot.resolution = render_resolution;
+	snapshot.filter = upscale_filter;
+	snapshot.recording = recording;
+	snapshot.recording_format = recording_format;
+	glfwGetFramebufferSize(window, &snapshot.framebuffer_size.x, &snapshot.framebuffer_size.y);
+}
 
-		if (registry.players.has(entity) && !registry.deathTimers.has(entity)) {
-			GLint invulnerable_time_loc = glGetUniformLocation(program, "invulnerable_timer");
-			glUniform1f(invulnerable_time_loc, registry.players.get(entity).invulnerable_timer);
-			GLint pi_loc = glGetUniformLocation(program, "M_PI");
-			glUniform1f(pi_loc, M_PI);
+void RenderSystem::captureText(RenderSnapshot &snapshot, const Text &text, vec2 position)
+{
+	float width = 0.f;
+	for (char c : text.string)
+		width += glyph(c).aspect * text.size + text.spacing;
+	if (!text.string.empty())
+		width -= text.spacing;
+	float x = position.x - width * (float)text.align / 2.f;
+
+	// every glyph has the same key apart from the index, so the string ends up in one batch
+	RenderItem item;
+	item.color = text.color;
+	item.params = { 0.f, 1.f };
+	item.texture = TEXTURE_ASSET_ID::GLYPHS;
+	item.effect = EFFECT_ASSET_ID::TEXTURED;
+	item.geometry = GEOMETRY_BUFFER_ID::SPRITE;
+	const uint program = effect_programs[(uint)item.effect];
+	for (char c : text.string)
+	{
+		const Glyph &cell = glyph(c);
+		const float advance = cell.aspect * text.size;
+		Transform transform;
+		transform.translate({ x + advance / 2.f, position.y });
+		transform.scale({ advance, text.size });
+		x += advance + text.spacing;
+		if (c == ' ')
+			continue;
+		if (!in_view(transform.mat)) {
+			culled_count++;
+			continue;
 		}
+		item.transform = transform.mat;
+		item.uv_rect = cell.uv_rect;
+		snapshot.queue.push_back(render_key(text.layer, 0, program, item, (uint)snapshot.items.size()));
+		snapshot.items.push_back(item);
+	}
+}
 
-        if (registry.healthBar.has(entity)) {
-            float percent = 0;
-            if (registry.enemies.has(registry.healthBar.get(entity).owner)) {
-                Enemies& enemy = registry.enemies.get(registry.healthBar.get(entity).owner);
-                percent = (float)enemy.health/(float)enemy.total_health;
-            }
-            GLint health_percent_loc = glGetUniformLocation(program, "percent");
-            glUniform1f(health_percent_loc, percent);
-        }
-
-		// Enabling and binding texture to slot 0
-		glActiveTexture(GL_TEXTURE0);
-		gl_has_errors();
+void RenderSystem::publish()
+{
+	assert(render_thread.joinable());
+	std::unique_lock<std::mutex> lock(snapshot_mutex);
+	snapshot_changed.wait(lock, [this]() { return !snapshot_pending && !snapshot_drawing; });
+	capture_index = 1 - capture_index;
+	snapshot_pending = true;
+	lock.unlock();
+	snapshot_changed.notify_all();
+}
 
-		GLuint texture_id = is_debug? texture_gl_handles[(GLuint) TEXTURE_ASSET_ID::HITBOX] :texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
-
-        assert(registry.renderRequests.has(entity));
-        if (registry.buttons.has(entity))
-        {
-            GameButton &button = registry.buttons.get(entity);
-            if (button.clicked) {
-                // pressed texture must be +1 of the unpressed texture
-                texture_id = texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture+1];
-            }
-        }
-		glBindTexture(GL_TEXTURE_2D, texture_id);
-		gl_has_errors();
-	}
-	else if (render_request.used_effect == EFFECT_ASSET_ID::COLOURED)
+void RenderSystem::startRenderThread()
+{
+	assert(!render_thread.joinable());
+	render_thread_quit = false;
+	// a context is current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	render_thread = std::thread(&RenderSystem::renderLoop, this);
+}
+
+void RenderSystem::stopRenderThread()
+{
+	if (!render_thread.joinable())
+		return;
 	{
-		GLint in_position_loc = glGetAttribLocation(program, "in_position");
-		gl_has_errors();
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		render_thread_quit = true;
+	}
+	snapshot_changed.notify_all();
+	render_thread.join();
+	glfwMakeContextCurrent(window);
+}
 
-		glEnableVertexAttribArray(in_position_loc);
-		glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE,
-							  sizeof(ColoredVertex), (void *)0);
-		gl_has_errors();
+void RenderSystem::renderLoop()
+{
+	glfwMakeContextCurrent(window);
+	std::unique_lock<std::mutex> lock(snapshot_mutex);
+	while (true)
+	{
+		snapshot_changed.wait(lock, [this]() { return snapshot_pending || render_thread_quit; });
+		// a published frame is still drawn when quitting
+		if (!snapshot_pending)
+			break;
+		snapshot_pending = false;
+		snapshot_drawing = true;
+		RenderSnapshot &snapshot = snapshots[1 - capture_index];
+		lock.unlock();
+
+		draw(snapshot);
+
+		lock.lock();
+		snapshot_drawing = false;
+		snapshot_changed.notify_all();
 	}
-	else if (render_request.used_effect == EFFECT_ASSET_ID::BULLET)
+	lock.unlock();
+	// the frames still in flight need the context
+	frame_capture.stop();
+	frame_capture_requested = false;
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderSystem::drawLayers(RENDER_LAYER first, RENDER_LAYER last, const mat3 &projection)
+{
+	resetBoundState();
+	for (uint k = layer_starts[(uint)first]; k < layer_starts[(uint)last + 1]; k++)
 	{
-		GLint in_position_loc = glGetAttribLocation(program, "in_position");
-		GLint in_color_loc = glGetAttribLocation(program, "in_color");
-		gl_has_errors();
+		uint64_t key = frame->queue[k];
+		const RenderItem &item = frame->items[(uint)(key & RENDER_KEY_INDEX_MASK)];
+		// debug hitboxes are never batched
+		if ((RENDER_LAYER)(key >> RENDER_KEY_LAYER_SHIFT) == RENDER_LAYER::DEBUG || !batchSprite(item, projection)) {
+			flushSprites(projection);
+			drawTexturedMesh(item, projection);
+		}
+	}
+	flushSprites(projection);
+	resetBoundState();
+}
+
+bool RenderSystem::hasLayers(RENDER_LAYER first, RENDER_LAYER last) const
+{
+	return layer_starts[(uint)first] != layer_starts[(uint)last + 1];
+}
+
+void RenderSystem::initializeFrameGraph()
+{
+	frame_graph.bind_target = [this](RENDER_TARGET target) { bindTarget(target); };
+
+	frame_graph.add_pass("scene", RENDER_TARGET::SCENE, nullptr, [this]() {
+		glClearColor(0.01f, 0.02f, 0.08f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		if (frame->parallax_visible)
+			drawParallax();
+		drawLayers(RENDER_LAYER::BACKGROUND, RENDER_LAYER::WORLD, frame_projection);
+		// streamed geometry goes on top of the world
+		flushStream(frame_projection);
+	});
+	// read back before the post-process dims it and the HUD goes on top
+	frame_graph.add_pass("capture", RENDER_TARGET::SCENE,
+		[this]() { return frame_capture.is_recording(); },
+		[this]() { frame_capture.capture(frame_buffer, screen_texture_size); });
+	frame_graph.add_pass("dialogue", RENDER_TARGET::DIALOGUE,
+		[this]() { return hasLayers(RENDER_LAYER::DIALOGUE, RENDER_LAYER::DIALOGUE); },
+		[this]() {
+			glClearColor(0, 0, 0, 0);
+			glClear(GL_COLOR_BUFFER_BIT);
+			drawLayers(RENDER_LAYER::DIALOGUE, RENDER_LAYER::DIALOGUE, frame_projection);
+		});
+	// pause, death fade and dialogue dims in one pass, skipped for a plain copy when they are all idle
+	frame_graph.add_pass("post-process", RENDER_TARGET::WINDOW,
+		[this]() { return !frame_post_params.is_idle(); },
+		[this]() { drawPostProcess(frame_post_params); });
+	frame_graph.add_pass("present", RENDER_TARGET::WINDOW,
+		[this]() { return frame_post_params.is_idle(); },
+		[this]() { drawToScreen(); });
+	// the HUD and debug hitboxes are drawn at window resolution, over the scene
+	frame_graph.add_pass("overlay", RENDER_TARGET::WINDOW,
+		[this]() { return hasLayers(RENDER_LAYER::OVERLAY, RENDER_LAYER::DEBUG); },
+		[this]() { drawLayers(RENDER_LAYER::OVERLAY, RENDER_LAYER::DEBUG, frame_projection); });
+}
+
+ivec4 RenderSystem::letterboxViewport(ivec2 framebuffer_size)
+{
+	// Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
+	int w = framebuffer_size.x, h = framebuffer_size.y;
+	float ox = 0, oy = 0;
+	float aspect_ratio = window_width_px / (float) window_height_px; // 16:9
+	float new_aspect_ratio = w / (float) h;
+	if (aspect_ratio < new_aspect_ratio) {
+		int new_w = h * aspect_ratio;
+		ox = (w-new_w)/2.0;
+		w = new_w;
+	} else {
+		int new_h = w / aspect_ratio;
+		oy = (h-new_h) / 2.0;
+		h = new_h;
+	}
+	return ivec4(ox, oy, w, h);
+}
+
+ivec2 RenderSystem::renderTargetSize(RENDER_RESOLUTION resolution, ivec2 framebuffer_size)
+{
+	switch (resolution) {
+		case RENDER_RESOLUTION::PIXEL_ART:
+			return { (int)round(bg_px_h * window_width_px / (float)window_height_px), bg_px_h };
+		case RENDER_RESOLUTION::DOUBLE:
+			return { 2 * window_width_px, 2 * window_height_px };
+		case RENDER_RESOLUTION::WINDOW: {
+			ivec4 viewport = letterboxViewport(framebuffer_size);
+			// minimized windows have no size
+			return max(ivec2(viewport.z, viewport.w), ivec2(1));
+		}
+		default:
+			return { window_width_px, window_height_px };
+	}
+}
+
+void RenderSystem::setRenderResolution(RENDER_RESOLUTION resolution, UPSCALE_FILTER filter)
+{
+	// the render thread reallocates its targets when a snapshot asks for something else
+	render_resolution = resolution;
+	upscale_filter = filter;
+}
+
+void RenderSystem::bindTarget(RENDER_TARGET target)
+{
+	if (target == RENDER_TARGET::SCENE || target == RENDER_TARGET::DIALOGUE) {
+		glBindFramebuffer(GL_FRAMEBUFFER, target == RENDER_TARGET::SCENE ? frame_buffer : dialogue_frame_buffer);
+		glViewport(0, 0, screen_texture_size.x, screen_texture_size.y);
+	} else {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		// black bar colors, can be changed
+		glClearColor(0, 0, 0, 1.0);
+		glClear(GL_COLOR_BUFFER_BIT);
+		window_viewport = letterboxViewport(frame->framebuffer_size);
+		glViewport(window_viewport.x, window_viewport.y, window_viewport.z, window_viewport.w);
+	}
+	gl_has_errors();
+}
+
+void RenderSystem::showParallax(bool visible)
+{
+	parallax_visible = visible;
+	parallax_time_ms = 0;
+}
+
+void RenderSystem::advanceParallax(float elapsed_ms)
+{
+	parallax_time_ms += elapsed_ms;
+}
+
+void RenderSystem::toggleRecording(CAPTURE_FORMAT format)
+{
+	recording = !recording;
+	recording_format = format;
+}
+
+void RenderSystem::drawParallax()
+{
+	glUseProgram(effects[(GLuint)EFFECT_ASSET_ID::PARALLAX]);
+	glUniform1f(effect_locations[(GLuint)EFFECT_ASSET_ID::PARALLAX].time, frame->parallax_time);
+	gl_has_errors();
+	// opaque, it replaces whatever the target was cleared to
+	glDisable(GL_BLEND);
+
+	glBindVertexArray(vertex_arrays[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]);
+	for (uint i = 0; i < PARALLAX_LAYER_COUNT; i++) {
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[(GLuint)parallax_layers[i].texture]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	gl_has_errors();
+
+	glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, nullptr);
+	glEnable(GL_BLEND);
+	gl_has_errors();
+	resetBoundState();
+}
+
+void RenderSystem::resetBoundState()
+{
+	bound_program = 0;
+	bound_geometry = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
+	bound_texture = 0;
+}
+
+void RenderSystem::drawTexturedMesh(const RenderItem &item, const mat3 &projection)
+{
+	const GLuint used_effect_enum = (GLuint)item.effect;
+	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
+	const GLuint program = (GLuint)effects[used_effect_enum];
+	const EffectLocations &locations = effect_locations[used_effect_enum];
 
-		glEnableVertexAttribArray(in_position_loc);
-		glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE,
-							  sizeof(ColoredVertex), (void *)0);
+	// Setting shaders, the queue is sorted so consecutive requests often share them
+	assert(item.geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
+	if (program != bound_program) {
+		glUseProgram(program);
 		gl_has_errors();
+		bound_program = program;
+	}
 
-		glEnableVertexAttribArray(in_color_loc);
-		glVertexAttribPointer(in_color_loc, 3, GL_FLOAT, GL_FALSE,
-							  sizeof(ColoredVertex), (void *)sizeof(vec3));
+	// Setting vertex and index buffers along with their layout
+	if (item.geometry != bound_geometry) {
+		assert(vertex_arrays[(GLuint)item.geometry] != 0);
+		glBindVertexArray(vertex_arrays[(GLuint)item.geometry]);
 		gl_has_errors();
+		bound_geometry = item.geometry;
+	}
+
+	if (is_sheet_effect(item.effect) || is_plain_textured_effect(item.effect))
+	{
+		// the animation's sprite sheet cell, or the whole texture
+		glUniform4fv(locations.uv_rect, 1, (float *)&item.uv_rect);
+		glUniform2fv(locations.params, 1, (float *)&item.params);
+
+		GLuint texture_id = texture_gl_handles[(GLuint)item.texture];
+		if (texture_id != bound_texture) {
+			// Enabling and binding texture to slot 0
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, texture_id);
+			gl_has_errors();
+			bound_texture = texture_id;
+		}
 	}
-	else
+	else if (item.effect != EFFECT_ASSET_ID::COLOURED && item.effect != EFFECT_ASSET_ID::BULLET)
 	{
 		assert(false && "Type of render request not supported");
 	}
 
-	// Getting uniform locations for glUniform* calls
-	GLint color_uloc = glGetUniformLocation(program, "fcolor");
-	const vec3 color = registry.colors.has(entity) ? registry.colors.get(entity) : vec3(1);
-	glUniform3fv(color_uloc, 1, (float *)&color);
+	glUniform3fv(locations.fcolor, 1, (float *)&item.color);
 	gl_has_errors();
 
-	// Get number of indices from index buffer, which has elements uint16_t
-	GLint size = 0;
-	glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-	gl_has_errors();
-
-	GLsizei num_indices = size / sizeof(uint16_t);
+	GLsizei num_indices = index_counts[(GLuint)item.geometry];
 	// GLsizei num_triangles = num_indices / 3;
 
-	GLint currProgram;
-	glGetIntegerv(GL_CURRENT_PROGRAM, &currProgram);
 	// Setting uniform values to the currently bound program
-	GLuint transform_loc = glGetUniformLocation(currProgram, "transform");
-	glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&transform.mat);
-	GLuint projection_loc = glGetUniformLocation(currProgram, "projection");
-	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	glUniformMatrix3fv(locations.transform, 1, GL_FALSE, (float *)&item.transform);
+	glUniformMatrix3fv(locations.projection, 1, GL_FALSE, (float *)&projection);
 	gl_has_errors();
 	// Drawing of num_indices/3 triangles specified in the index buffer
 	glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
 	gl_has_errors();
 }
 
-void RenderSystem::drawDialogueLayer(const mat3 &projection, int dialogue)
+PostParams RenderSystem::postParams() const
 {
-    Transform transform;
-    transform.translate(vec2(window_width_px/2.0, window_height_px/2.0));
-    transform.scale(vec2(window_width_px, window_height_px));
-
-    const GLuint program = (GLuint)effects[(GLuint)EFFECT_ASSET_ID::DIALOGUE_LAYER];
-
-    // Setting shaders
-    glUseProgram(program);
-    gl_has_errors();
-
-    const GLuint vbo = vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE];
-    const GLuint ibo = index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE];
-
-    // Setting vertex and index buffers
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    gl_has_errors();
-
-    GLint in_texcoord_loc = glGetAttribLocation(program, "in_texcoord");
-    glEnableVertexAttribArray(in_texcoord_loc);
-    glVertexAttribPointer(
-            in_texcoord_loc, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex),
-            (void *)sizeof(
-                    vec3)); // note the stride to skip the preceeding vertex position
-
-    // Enabling and binding texture to slot 0
-    glActiveTexture(GL_TEXTURE0);
-    gl_has_errors();
-
-    GLuint texture_id = texture_gl_handles[(GLuint) TEXTURE_ASSET_ID::BLACK_LAYER];
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    gl_has_errors();
-
-    GLuint dialogue_uloc = glGetUniformLocation(program, "show_dialogue_screen");
-    glUniform1i(dialogue_uloc, dialogue != 0);
-    gl_has_errors();
-
-    // Getting uniform locations for glUniform* calls
-    GLint color_uloc = glGetUniformLocation(program, "fcolor");
-    const vec3 color = vec3(1.f,1.f,1.f);
-    glUniform3fv(color_uloc, 1, (float *)&color);
-    gl_has_errors();
-
-    // Get number of indices from index buffer, which has elements uint16_t
-    GLint size = 0;
-    glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-    gl_has_errors();
-
-    GLsizei num_indices = size / sizeof(uint16_t);
-    // GLsizei num_triangles = num_indices / 3;
-
-    GLint currProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currProgram);
-    // Setting uniform values to the currently bound program
-    GLuint transform_loc = glGetUniformLocation(currProgram, "transform");
-    glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&transform.mat);
-    GLuint projection_loc = glGetUniformLocation(currProgram, "projection");
-    glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
-    gl_has_errors();
-    // Drawing of num_indices/3 triangles specified in the index buffer
-    glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
-    gl_has_errors();
-}
-
-void RenderSystem::drawScreenLayer(const mat3 &projection, bool pause)
-{
-    Transform transform;
-    transform.translate(vec2(window_width_px/2.0, window_height_px/2.0));
-    transform.scale(vec2(window_width_px, window_height_px));
-
-    const GLuint program = (GLuint)effects[(GLuint)EFFECT_ASSET_ID::SCREEN_LAYER];
-
-    // Setting shaders
-    glUseProgram(program);
-    gl_has_errors();
-
-    const GLuint vbo = vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE];
-    const GLuint ibo = index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE];
-
-    // Setting vertex and index buffers
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    gl_has_errors();
-
-
-    GLint in_texcoord_loc = glGetAttribLocation(program, "in_texcoord");
-    glEnableVertexAttribArray(in_texcoord_loc);
-    glVertexAttribPointer(
-            in_texcoord_loc, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex),
-            (void *)sizeof(
-                    vec3)); // note the stride to skip the preceeding vertex position
-
-    // Enabling and binding texture to slot 0
-    glActiveTexture(GL_TEXTURE0);
-    gl_has_errors();
-
-    GLuint texture_id = texture_gl_handles[(GLuint) TEXTURE_ASSET_ID::BLACK_LAYER];
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    gl_has_errors();
-
-    // Set clock
-    GLuint time_uloc = glGetUniformLocation(program, "time");
-    GLuint dead_timer_uloc = glGetUniformLocation(program, "screen_darken_factor");
-    GLuint pause_uloc = glGetUniformLocation(program, "pause");
-    glUniform1f(time_uloc, (float)(glfwGetTime() * 10.0f));
-    ScreenState &screen = registry.screenStates.get(screen_state_entity);
-    glUniform1f(dead_timer_uloc, screen.screen_darken_factor);
-    glUniform1i(pause_uloc, pause);
-    gl_has_errors();
-
-    // Getting uniform locations for glUniform* calls
-    GLint color_uloc = glGetUniformLocation(program, "fcolor");
-    const vec3 color = vec3(1.f,1.f,1.f);
-    glUniform3fv(color_uloc, 1, (float *)&color);
-    gl_has_errors();
-
-    // Get number of indices from index buffer, which has elements uint16_t
-    GLint size = 0;
-    glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-    gl_has_errors();
-
-    GLsizei num_indices = size / sizeof(uint16_t);
-    // GLsizei num_triangles = num_indices / 3;
-
-    GLint currProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currProgram);
-    // Setting uniform values to the currently bound program
-    GLuint transform_loc = glGetUniformLocation(currProgram, "transform");
-    glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&transform.mat);
-    GLuint projection_loc = glGetUniformLocation(currProgram, "projection");
-    glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
-    gl_has_errors();
-    // Drawing of num_indices/3 triangles specified in the index buffer
-    glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr);
-    gl_has_errors();
+	PostParams params = {};
+	params.dialogue_dim = frame->dialogue != 0 ? 0.6f : 0.f;
+	float screen_dim = frame->pause ? 0.6f : 0.f;
+	if (frame->screen_darken_factor > 0)
+		screen_dim += 0.9f * frame->screen_darken_factor;
+	params.screen_dim = min(screen_dim, 1.f);
+	params.has_dialogue_layer = hasLayers(RENDER_LAYER::DIALOGUE, RENDER_LAYER::DIALOGUE);
+	// a target already at the window's size is copied pixel for pixel either way
+	const ivec4 viewport = letterboxViewport(frame->framebuffer_size);
+	params.source_size = vec2(screen_texture_size);
+	params.output_size = vec2(viewport.z, viewport.w);
+	params.sharp_bilinear = frame->filter == UPSCALE_FILTER::SHARP_BILINEAR && params.source_size != params.output_size;
+	return params;
 }
-void RenderSystem::drawToScreen()
+
+void RenderSystem::drawPostProcess(const PostParams &params)
 {
+	glBindBuffer(GL_UNIFORM_BUFFER, post_params_buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(PostParams), &params);
+	gl_has_errors();
+
 	// Setting shaders
-	// get the water texture, sprite mesh, and program
 	glUseProgram(effects[(GLuint)EFFECT_ASSET_ID::SCREEN]);
 	gl_has_errors();
-	// Clearing backbuffer
-	int w, h;
-    float ox = 0, oy = 0;
-	glfwGetFramebufferSize(window, &w, &h); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
-    float aspect_ratio = window_width_px / (float) window_height_px; // 16:9
-    float new_aspect_ratio = w / (float) h;
-    if (aspect_ratio < new_aspect_ratio) {
-        int new_w = h * aspect_ratio;
-        ox = (w-new_w)/2.0;
-        w = new_w;
-    } else {
-        int new_h = w / aspect_ratio;
-        oy = (h-new_h) / 2.0;
-        h = new_h;
-    }
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(ox, oy, w, h);
-	glDepthRange(0, 10);
-    // black bar colors, can be changed
-	glClearColor(0, 0, 0, 1.0);
-	glClearDepth(1.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	gl_has_errors();
-	// Enabling alpha channel for textures
-	glEnable(GL_BLEND);
-	// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_DEPTH_TEST);
+	// the scene's alpha is not coverage, it must not blend with the backbuffer
+	glDisable(GL_BLEND);
 
 	// Draw the screen texture on the quad geometry
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]);
-	glBindBuffer(
-		GL_ELEMENT_ARRAY_BUFFER,
-		index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]); // Note, GL_ELEMENT_ARRAY_BUFFER associates
-																	 // indices to the bound GL_ARRAY_BUFFER
-	gl_has_errors();
-	const GLuint water_program = effects[(GLuint)EFFECT_ASSET_ID::SCREEN];
-	gl_has_errors();
-	// Set the vertex position and vertex texture coordinates (both stored in the
-	// same VBO)
-	GLint in_position_loc = glGetAttribLocation(water_program, "in_position");
-	glEnableVertexAttribArray(in_position_loc);
-	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void *)0);
+	glBindVertexArray(vertex_arrays[(GLuint)GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE]);
 	gl_has_errors();
 
-	// Bind our texture in Texture Unit 0
+	// Bind our textures in Texture Units 0 and 1
 	glActiveTexture(GL_TEXTURE0);
-
 	glBindTexture(GL_TEXTURE_2D, off_screen_render_buffer_color);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, dialogue_texture);
+	glActiveTexture(GL_TEXTURE0);
 	gl_has_errors();
 	// Draw
 	glDrawElements(
 		GL_TRIANGLES, 3, GL_UNSIGNED_SHORT,
 		nullptr); // one triangle = 3 vertices; nullptr indicates that there is
 				  // no offset from the bound index buffer
+	glEnable(GL_BLEND);
+	gl_has_errors();
+}
+
+void RenderSystem::drawToScreen()
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, frame_buffer);
+	glBlitFramebuffer(0, 0, screen_texture_size.x, screen_texture_size.y,
+					  window_viewport.x, window_viewport.y, window_viewport.x + window_viewport.z, window_viewport.y + window_viewport.w,
+					  GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 	gl_has_errors();
 }
 
 // Render our game world
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
-void RenderSystem::draw(bool pause, bool debug, int dialogue)
+void RenderSystem::draw(RenderSnapshot &snapshot)
 {
-	// Getting size of window
-	int w, h;
-	glfwGetFramebufferSize(window, &w, &h); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
+	frame = &snapshot;
 
-	// First render to the custom framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
-	gl_has_errors();
-	// Clearing backbuffer
-	glViewport(0, 0, w, h);
-	glDepthRange(0.00001, 10);
-	glClearColor(0.01f, 0.02f, 0.08f, 1.0f);
-	glClearDepth(10.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// alpha accumulates as coverage so the dialogue target ends up premultiplied
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     glDisable(GL_DEPTH_TEST); // native OpenGL does not work with a depth buffer
 							  // and alpha blending, one would have to sort
 							  // sprites back to front
 	gl_has_errors();
-	mat3 projection_2D = createProjectionMatrix();
-    std::vector<Entity> beyonders;
-    // separates what needs the screen effects and what doesn't need screen effect, Not the most efficient, could look into it later
-    // Truely render to the screen
-    drawToScreen();
-	for (Entity entity : registry.renderRequests.entities)
-	{
-        RenderRequest &render_request = registry.renderRequests.get(entity);
-		if (registry.dialogues.has(entity) || registry.dialogueTexts.has(entity))
-			continue;
-		if (!registry.motions.has(entity) || !render_request.visibility)
-			continue;
-		if (render_request.on_top_screen) {
-            beyonders.push_back(entity);
-        } else {
-            drawTexturedMesh(entity, projection_2D, pause);
-        }
+
+	// follows window resizes when the target is sized by the window
+	ivec2 target_size = renderTargetSize(snapshot.resolution, snapshot.framebuffer_size);
+	if (target_size != screen_texture_size || snapshot.filter != screen_texture_filter)
+		resizeRenderTargets(target_size, snapshot.filter);
+
+	// only on changes, a recording that failed to start is not retried every frame
+	if (snapshot.recording != frame_capture_requested) {
+		frame_capture_requested = snapshot.recording;
+		if (snapshot.recording)
+			frame_capture.start(data_path() + "/captures", snapshot.recording_format);
+		else
+			frame_capture.stop();
 	}
 
-	drawDialogueLayer(projection_2D, dialogue);
+	frame_projection = createProjectionMatrix();
 
-	if (registry.dialogues.entities.size() != 0) {
-		drawTexturedMesh(registry.dialogues.entities[0], projection_2D, pause);
-	}
+	std::vector<uint64_t> &queue = snapshot.queue;
+	if (!queue.empty())
+		radix_sort(queue, render_queue_scratch);
+	// the queue is sorted by layer first, so each layer is one contiguous range of it
+	for (uint layer = 0; layer <= (uint)RENDER_LAYER::LAYER_COUNT; layer++)
+		layer_starts[layer] = (uint)(std::lower_bound(queue.begin(), queue.end(), (uint64_t)layer << RENDER_KEY_LAYER_SHIFT) - queue.begin());
 
-	if (registry.dialogueTexts.entities.size() != 0) {
-		drawTexturedMesh(registry.dialogueTexts.entities[0], projection_2D, pause);
-	}
+	frame_post_params = postParams();
 
-    drawScreenLayer(projection_2D, pause);
-    //draws whatever is filtered out as on top of the screen effects.
-    for (Entity e : beyonders) {
-        drawTexturedMesh(e, projection_2D, pause);
-    }
-    if (debug) {
-        for (Entity entity : registry.debugRenderRequests.entities)
-        {
-            if (registry.weaponHitBoxes.has(entity) && !registry.weaponHitBoxes.get(entity).isActive) {
-                continue;
-            }
-            drawTexturedMesh(entity, projection_2D, pause, true);
-        }
-    }
+	frame_graph.execute();
 
 	// flicker-free display with a double buffer
 	glfwSwapBuffers(window);
 	gl_has_errors();
+	frame = nullptr;
 }
 
 mat3 RenderSystem::createProjectionMatrix()
@@ -1,11 +1,178 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include "common.hpp"
 #include "components.hpp"
 #include "tiny_ecs.hpp"
+#include "stream_buffer.hpp"
+#include "frame_graph.hpp"
+#include "glyph_atlas.hpp"
+#include "frame_capture.hpp"
+
+// Layout of the render queue sort keys
+const uint RENDER_KEY_LAYER_SHIFT = 60;
+const uint64_t RENDER_KEY_INDEX_MASK = 0xFFFFFFFFull;
+
+// Vertex attribute locations, bound by name before every effect is linked so that one vertex
+// array object per geometry works with any program
+const GLuint ATTRIB_IN_POSITION = 0;
+const GLuint ATTRIB_IN_TEXCOORD = 1;
+const GLuint ATTRIB_IN_COLOR = 2;
+// Per instance attributes of the instanced sprite shader, they follow the per vertex ones
+const GLuint ATTRIB_IN_TRANSFORM = 3; // takes three locations, one per column
+const GLuint ATTRIB_IN_TINT = 6;
+const GLuint ATTRIB_IN_UV_RECT = 7;
+const GLuint ATTRIB_IN_PARAMS = 8;
+
+// Uniform buffer binding of the post-process parameters
+const GLuint POST_PARAMS_BINDING = 0;
+
+// Size of the offscreen target the scene is drawn at, before it is scaled to the window
+enum class RENDER_RESOLUTION
+{
+	// bg_px_h rows, the background's own pixels
+	PIXEL_ART = 0,
+	// window_width_px by window_height_px, one world unit per pixel
+	NATIVE = PIXEL_ART + 1,
+	DOUBLE = NATIVE + 1,
+	// the letterboxed window, whatever its size
+	WINDOW = DOUBLE + 1,
+	RESOLUTION_COUNT = WINDOW + 1
+};
+
+// How the scene is scaled to the window
+enum class UPSCALE_FILTER
+{
+	NEAREST = 0,
+	// nearest neighbour by the largest whole factor, bilinear for the rest, so no pixel row is wider
+	// than the others and the edges stay sharp
+	SHARP_BILINEAR = NEAREST + 1,
+	FILTER_COUNT = SHARP_BILINEAR + 1
+};
+
+const RENDER_RESOLUTION DEFAULT_RENDER_RESOLUTION = RENDER_RESOLUTION::NATIVE;
+const UPSCALE_FILTER DEFAULT_UPSCALE_FILTER = UPSCALE_FILTER::SHARP_BILINEAR;
+
+// must match the layer count in shaders/parallax.fs.glsl
+const uint PARALLAX_LAYER_COUNT = 8;
+
+// One layer of the parallax background, see RenderSystem::parallax_layers
+struct ParallaxLayer
+{
+	TEXTURE_ASSET_ID texture;
+	// top left corner and size of the texture in window pixels, before any scrolling
+	vec2 origin;
+	vec2 size;
+	// pixels per second
+	vec2 velocity;
+	// 1 along the axes the texture tiles on, it is only drawn once on the others
+	vec2 repeat;
+};
+
+// Everything the render thread needs to draw one visible request, resolved from the registry when
+// the frame is captured
+struct RenderItem
+{
+	mat3 transform;
+	vec3 color;
+	// the part of the texture shown (x, y, width, height in uv), the animation's sprite sheet cell
+	vec4 uv_rect;
+	// see shaders/sprite_features.glsl
+	vec2 params;
+	// the pressed variant for clicked buttons, the hitbox for debug requests
+	TEXTURE_ASSET_ID texture;
+	EFFECT_ASSET_ID effect;
+	GEOMETRY_BUFFER_ID geometry;
+};
+
+// Consecutive streamed vertices sharing a texture, drawn with one call
+struct StreamRun
+{
+	TEXTURE_ASSET_ID texture;
+	GLint first;
+	GLsizei count;
+};
+
+// One frame as the simulation left it. The render thread draws it while the next one is simulated,
+// so nothing in it may point back into the registry
+struct RenderSnapshot
+{
+	std::vector<RenderItem> items;
+	// sort keys of the items, see render_key in render_system.cpp. Sorted by the render thread
+	std::vector<uint64_t> queue;
+	std::vector<TexturedVertex> stream_vertices;
+	std::vector<StreamRun> stream_runs;
+
+	bool pause = false;
+	int dialogue = 0;
+	float screen_darken_factor = -1;
+	bool parallax_visible = false;
+	float parallax_time = 0;
+	RENDER_RESOLUTION resolution = DEFAULT_RENDER_RESOLUTION;
+	UPSCALE_FILTER filter = DEFAULT_UPSCALE_FILTER;
+	bool recording = false;
+	CAPTURE_FORMAT recording_format = CAPTURE_FORMAT::PNG;
+	// the window's framebuffer, only the main thread may ask GLFW for it
+	ivec2 framebuffer_size = { 0, 0 };
+};
+
+// Requests whose bounds end this far outside the window are culled before they are queued
+const float RENDER_CULL_MARGIN = 32.f;
+
+// Most vertices streamed in one frame, six per quad
+const uint STREAM_MAX_VERTICES = 6 * 2048;
+
+// Locations of everything the draw code sets on an effect's program, looked up once when the
+// effects are loaded. -1 when the effect does not use it, which glUniform* silently ignores
+struct EffectLocations
+{
+	// uniforms shared by most effects
+	GLint transform;
+	GLint projection;
+	GLint fcolor;
+	// the part of the texture a sprite shows
+	GLint uv_rect;
+	// sprite feature parameters, see shaders/sprite_features.glsl
+	GLint params;
+	// post-process
+	GLint screen_texture;
+	GLint dialogue_texture;
+	GLuint post_params;
+	// seconds the parallax background has scrolled for
+	GLint time;
+};
+
+EffectLocations reflect_effect(GLuint program);
+
+// std140 layout of the PostParams block in screen.fs.glsl
+struct PostParams
+{
+	// how much the world below the dialogue layer is darkened
+	float dialogue_dim;
+	// how much everything below the overlay is darkened, pause and death fade combined
+	float screen_dim;
+	int has_dialogue_layer;
+	int sharp_bilinear;
+	// scene target and window viewport sizes in pixels, for sharp bilinear scaling
+	vec2 source_size;
+	vec2 output_size;
+
+	// Whether a plain copy of the scene gives the same image
+	bool is_idle() const { return dialogue_dim <= 0 && screen_dim <= 0 && !has_dialogue_layer && !sharp_bilinear; }
+};
+
+// Shader pair (path without the .vs.glsl/.fs.glsl suffix) and the defines an effect's program is
+// compiled with. Effects with the same source and defines share one program
+struct EffectSource
+{
+	std::string path;
+	std::vector<std::string> defines;
+};
 
 // System responsible for setting up OpenGL and for rendering all the
 // visual entities in the game
@@ -20,6 +187,13 @@ class RenderSystem
 	 */
 	std::array<GLuint, texture_count> texture_gl_handles;
 	std::array<ivec2, texture_count> texture_dimensions;
+	// Where the instanced path samples each texture: the atlas page holding it and its rect there
+	// (x, y, width, height in uv). Textures too big for the atlas map to their own handle and the whole uv range
+	std::vector<GLuint> atlas_pages;
+	std::array<GLuint, texture_count> texture_atlas_page;
+	std::array<vec4, texture_count> texture_uv_rects;
+	// cells of the GLYPHS texture, read by the simulation when laying out text
+	std::array<Glyph, glyph_count> glyphs;
 
 	// Make sure these paths remain in sync with the associated enumerators.
 	// Associated id with .obj path
@@ -133,36 +307,58 @@ class RenderSystem
 		textures_path("dialogues/dialogue_7_hades.png"),
 		textures_path("dialogues/dialogue_8_hades.png"),
 		textures_path("difficulty/single_boss_difficulty_bar.png"),
-		textures_path("difficulty/single_broken_difficulty_bar.png") };
+		textures_path("difficulty/single_broken_difficulty_bar.png"),
+		"" };
 
 
 	std::array<GLuint, effect_count> effects;
-	// Make sure these paths remain in sync with the associated enumerators.
-	const std::array<std::string, effect_count> effect_paths = {
-		shader_path("coloured"),
-		shader_path("textured"),
-		shader_path("bullet"),
-		shader_path("screen"),
-		shader_path("animated"),
-		shader_path("hero"),
-		shader_path("explosion"),
-		shader_path("water_ball"),
-		shader_path("fire_enemy"),
-		shader_path("ghoul"),
-		shader_path("spitter"),
-		shader_path("spitter_bullet"),
-		shader_path("following_enemy"),
-        shader_path("screen_layer"),
-		shader_path("lava_pillar"),
-        shader_path("boss"),
-		shader_path("boss_sword_small"),
-		shader_path("boss_sword_large"),
-        shader_path("health_bar"),
-		shader_path("dialogue_layer"),
-		shader_path("grenade_orb")};
+	std::array<EffectLocations, effect_count> effect_locations;
+	// index of each effect's program in programs, effects sharing one sort and batch together
+	std::array<uint8_t, effect_count> effect_programs;
+	std::vector<GLuint> programs;
+	// Make sure these sources remain in sync with the associated enumerators.
+	// Everything drawn as a textured sprite is a variant of the sprite uber-shader
+	const std::array<EffectSource, effect_count> effect_sources = {
+		EffectSource{ shader_path("coloured") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("bullet") },
+		EffectSource{ shader_path("screen") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite"), {"FEATURE_FLASH"} },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite"), {"FEATURE_HEALTH_CUT"} },
+		EffectSource{ shader_path("sprite") },
+		EffectSource{ shader_path("sprite"), {"INSTANCED", "FEATURE_FLASH", "FEATURE_HEALTH_CUT"} },
+		EffectSource{ shader_path("parallax") } };
+
+	// Back to front, the lava is the only layer in front of the level
+	const std::array<ParallaxLayer, PARALLAX_LAYER_COUNT> parallax_layers = {
+		ParallaxLayer{ TEXTURE_ASSET_ID::BACKGROUND_COLOR, { 0, 0 }, { 1200, 800 }, { 0, 0 }, { 0, 0 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_MOON, { 0, 0 }, { 1160, 800 }, { 0, 0 }, { 0, 0 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR, { 0, 0 }, { 1200, 800 }, { 25, 0 }, { 1, 0 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE, { 0, 0 }, { 1200, 800 }, { 50, 0 }, { 1, 0 } },
+		// two sheets of rain out of step with each other
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_RAIN, { -200, 0 }, { 1200, 800 }, { 200, 600 }, { 1, 1 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_RAIN, { 0, 400 }, { 1200, 800 }, { 200, 600 }, { 1, 1 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::BACKGROUND, { 0, 0 }, { 1200, 800 }, { 0, 0 }, { 0, 0 } },
+		ParallaxLayer{ TEXTURE_ASSET_ID::PARALLAX_LAVA, { 0, 35 }, { 1200, 800 }, { 50, 0 }, { 1, 0 } } };
 
 	std::array<GLuint, geometry_count> vertex_buffers;
 	std::array<GLuint, geometry_count> index_buffers;
+	// number of uint16_t indices in each index buffer
+	std::array<GLsizei, geometry_count> index_counts = {};
+	// one per geometry, holding its buffers and vertex format. 0 for geometry that was never loaded
+	std::array<GLuint, geometry_count> vertex_arrays = {};
 	std::array<Mesh, geometry_count> meshes;
 	std::array<CollisionMesh, geometry_count> collisionMeshes;
 
@@ -174,6 +370,9 @@ public:
 	void bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices);
 
 	void initializeGlTextures();
+	// Packs the sprites whose pixels are given (nullptr for the others) into atlas pages
+	void initializeTextureAtlas(const std::vector<const unsigned char*>& atlas_data);
+	const Glyph &glyph(char c) const { return find_glyph(glyphs, c); }
 
 	void initializeGlEffects();
 
@@ -184,25 +383,111 @@ public:
 	CollisionMesh& getCollisionMesh(GEOMETRY_BUFFER_ID id) {return collisionMeshes[(int)id]; };
 
 	void initializeGlGeometryBuffers();
+	// Creates the buffer per sprite instance data is streamed through
+	void initializeSpriteBatch();
+	// Creates the ring buffer streamed geometry goes through
+	void initializeStream();
+	// Creates the post-process parameter buffer and points the post-process program at it
+	void initializePostProcess();
+	// Hands the layer table to the parallax program
+	void initializeParallax();
+	// Sets up the passes draw runs every frame
+	void initializeFrameGraph();
 	// Initialize the screen texture used as intermediate render target
 	// The draw loop first renders to this texture, then it is used for the water
 	// shader
 	bool initScreenTexture();
+	// Reallocates the scene and dialogue targets, filtered for the upscale filter
+	void resizeRenderTargets(ivec2 size, UPSCALE_FILTER filter);
+
+	// Takes effect from the next captured frame
+	void setRenderResolution(RENDER_RESOLUTION resolution, UPSCALE_FILTER filter);
+	RENDER_RESOLUTION getRenderResolution() const { return render_resolution; }
+	UPSCALE_FILTER getUpscaleFilter() const { return upscale_filter; }
 
 	// Destroy resources associated to one or all entities created by the system
 	~RenderSystem();
 
-	// Draw all entities
-	void draw(bool pause, bool debug, int dialogue);
+	// Hands the GL context to a thread of its own that draws the published snapshots. Call once
+	// everything is initialized, the calling thread must not touch GL until stopRenderThread
+	void startRenderThread();
+	// Waits for the frame being drawn and takes the context back to the calling thread
+	void stopRenderThread();
+
+	// Resolves every visible request into the snapshot the simulation fills next
+	void capture(bool pause, bool debug, int dialogue);
+	// Hands the captured snapshot to the render thread. Waits while it is still drawing the previous
+	// one, so the simulation runs at most one frame ahead
+	void publish();
 
 	mat3 createProjectionMatrix();
 
+	// stats for the last captured frame, shown in debug mode
+	uint submitted_count = 0;
+	uint culled_count = 0;
+
+	// Geometry without an entity of its own (trajectories), in world coordinates and drawn on top of
+	// the world layer. It is kept until the next clearStream so it stays up while the game is paused
+	void clearStream();
+	void streamQuad(vec2 center, vec2 scale, float angle, TEXTURE_ASSET_ID texture);
+	// One quad of the given width along each segment
+	void streamPolyline(const std::vector<vec2> &points, float width, TEXTURE_ASSET_ID texture);
+
+	// The background behind the level, all of its layers composited in one full screen pass.
+	// Showing it starts the layers over from where they were laid out
+	void showParallax(bool visible);
+	void advanceParallax(float elapsed_ms);
+
+	// Records the scene target to data/captures from the next captured frame on, or stops recording
+	void toggleRecording(CAPTURE_FORMAT format);
+	bool isRecording() const { return recording; }
+
 private:
+	// Per instance data of the instanced sprite path, attribute locations are fixed in sprite.vs.glsl
+	struct SpriteInstance
+	{
+		mat3 transform;
+		vec3 color;
+		// where the shown part of the texture is in its atlas page, the sprite sheet cell for animations
+		vec4 uv_rect;
+		// see shaders/sprite_features.glsl
+		vec2 params;
+	};
+
+	// Lays a string out into one glyph item per character
+	void captureText(RenderSnapshot &snapshot, const Text &text, vec2 position);
+	// Draws a snapshot, on the render thread
+	void draw(RenderSnapshot &snapshot);
+	void renderLoop();
+
 	// Internal drawing functions for each entity type
-	void drawTexturedMesh(Entity entity, const mat3 &projection, bool pause, bool is_debug = false);
+	void drawTexturedMesh(const RenderItem &item, const mat3 &projection);
+	// Queues a sprite for the instanced path, false if it needs drawTexturedMesh instead.
+	// Consecutive sprites with the same texture end up in the same draw call
+	bool batchSprite(const RenderItem &item, const mat3 &projection);
+	// Draws whatever has been queued with a single instanced call
+	void flushSprites(const mat3 &projection);
+	// Uploads the streamed geometry and draws it, one call per run
+	void flushStream(const mat3 &projection);
+	// Draws the queued requests of the layers from first to last
+	void drawLayers(RENDER_LAYER first, RENDER_LAYER last, const mat3 &projection);
+	// Whether anything was queued in the layers from first to last this frame
+	bool hasLayers(RENDER_LAYER first, RENDER_LAYER last) const;
+	void bindTarget(RENDER_TARGET target);
+	// The largest rectangle with the game's aspect ratio in the framebuffer, x, y, width, height
+	static ivec4 letterboxViewport(ivec2 framebuffer_size);
+	// Size of the scene target for the resolution setting and window framebuffer
+	static ivec2 renderTargetSize(RENDER_RESOLUTION resolution, ivec2 framebuffer_size);
+	// Forgets what drawTexturedMesh last bound, after anything else touched the GL state
+	void resetBoundState();
+	// What the post-process pass has to do this frame
+	PostParams postParams() const;
+	// Composes the scene and dialogue textures into the letterboxed window, dimming them
+	void drawPostProcess(const PostParams &params);
+	// Copies the scene texture into the letterboxed window as is
 	void drawToScreen();
-    void drawScreenLayer(const mat3 &projection, bool pause);
-	void drawDialogueLayer(const mat3 &projection, int dialogue);
+	// Covers the bound target with the parallax background
+	void drawParallax();
 
 	// Window handle
 	GLFWwindow *window;
@@ -210,10 +495,72 @@ private:
 	// Screen texture handles
 	GLuint frame_buffer;
 	GLuint off_screen_render_buffer_color;
-	GLuint off_screen_render_buffer_depth;
+	ivec2 screen_texture_size = { 0, 0 };
+	UPSCALE_FILTER screen_texture_filter = DEFAULT_UPSCALE_FILTER;
+	// the settings captured into the next snapshot
+	RENDER_RESOLUTION render_resolution = DEFAULT_RENDER_RESOLUTION;
+	UPSCALE_FILTER upscale_filter = DEFAULT_UPSCALE_FILTER;
+	bool parallax_visible = false;
+	float parallax_time_ms = 0;
+	bool recording = false;
+	CAPTURE_FORMAT recording_format = CAPTURE_FORMAT::PNG;
+	// the dialogue layer is drawn apart so the post-process can dim only what is below it
+	GLuint dialogue_frame_buffer;
+	GLuint dialogue_texture;
+	GLuint post_params_buffer;
+	// where the window target's viewport is, x, y, width, height
+	ivec4 window_viewport;
 
 	Entity screen_state_entity;
+
+	FrameGraph frame_graph;
+	// what the passes of the current frame draw, set by draw on the render thread
+	const RenderSnapshot *frame = nullptr;
+	mat3 frame_projection;
+	PostParams frame_post_params = {};
+	// where each layer starts in the frame's queue, the last one is the queue's end
+	std::array<uint, (uint)RENDER_LAYER::LAYER_COUNT + 1> layer_starts = {};
+	std::vector<uint64_t> render_queue_scratch;
+	// owned by the render thread, which follows the snapshots' recording flag
+	FrameCapture frame_capture;
+	bool frame_capture_requested = false;
+
+	// The simulation captures into snapshots[capture_index] while the render thread draws the other
+	std::array<RenderSnapshot, 2> snapshots;
+	uint capture_index = 0;
+	std::thread render_thread;
+	std::mutex snapshot_mutex;
+	std::condition_variable snapshot_changed;
+	// a published snapshot the render thread has not taken yet
+	bool snapshot_pending = false;
+	bool snapshot_drawing = false;
+	bool render_thread_quit = false;
+	// state drawTexturedMesh left bound, to skip redundant changes between consecutive requests
+	GLuint bound_program = 0;
+	GEOMETRY_BUFFER_ID bound_geometry = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
+	GLuint bound_texture = 0;
+
+	GLuint sprite_instance_buffer;
+	// sprite quad plus the instance attributes
+	GLuint sprite_instance_vao;
+	GLuint sprite_batch_texture = 0;
+	std::vector<SpriteInstance> sprite_instances;
+
+	StreamBuffer stream_buffer;
+	GLuint stream_vao;
+	// written by the simulation, copied into every snapshot
+	std::vector<TexturedVertex> stream_vertices;
+	std::vector<StreamRun> stream_runs;
 };
 
+// Reads a shader, expanding #include "file" (relative to the including file) and adding a #define
+// after the #version line for each of the defines
+bool preprocessShader(const std::string &path, const std::vector<std::string> &defines, std::string &out_source);
+
+class ShaderCache;
+
+// Programs built from source are stored in the cache when one is given, and taken from it when
+// the preprocessed sources match
 bool loadEffectFromFile(
-	const std::string &vs_path, const std::string &fs_path, GLuint &out_program);
+	const std::string &vs_path, const std::string &fs_path, GLuint &out_program,
+	const std::vector<std::string> &defines = {}, ShaderCache *cache = nullptr);
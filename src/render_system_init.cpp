@@ -1,7 +1,13 @@
 // internal
 #include "render_system.hpp"
+#include "texture_atlas.hpp"
+#include "asset_loader.hpp"
+#include "asset_archive.hpp"
+#include "shader_cache.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <fstream>
 
 #include "../ext/stb_image/stb_image.h"
@@ -10,6 +16,8 @@
 #include "tiny_ecs_registry.hpp"
 
 // stlib
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -48,17 +56,15 @@ bool RenderSystem::init(GLFWwindow *window_arg)
 	// code to use OpenGL 4.3 (not suported on mac) and add additional .h and .cpp
 	// glDebugMessageCallback((GLDEBUGPROC)errorCallback, nullptr);
 
-	// We are not really using VAO's but without at least one bound we will crash in
-	// some systems.
-	GLuint vao;
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	gl_has_errors();
-
 	initScreenTexture();
 	initializeGlTextures();
 	initializeGlEffects();
 	initializeGlGeometryBuffers();
+	initializeSpriteBatch();
+	initializeStream();
+	initializePostProcess();
+	initializeParallax();
+	initializeFrameGraph();
 
 	return true;
 }
@@ -67,46 +73,198 @@ void RenderSystem::initializeGlTextures()
 {
 	glGenTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
 
+	// pixels of the sprites going into the atlas, kept until it is built
+	std::vector<const stbi_uc*> atlas_data(texture_paths.size(), nullptr);
+	auto upload = [this, &atlas_data](uint i, const stbi_uc *data) {
+		const ivec2 &dimensions = texture_dimensions[i];
+		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		gl_has_errors();
+		if (fits_in_atlas(dimensions))
+			atlas_data[i] = data;
+	};
+
+	// packed textures are uploaded straight from the archive, the others are decoded from their files
+	const AssetArchive &archive = asset_archive();
+	std::vector<stbi_uc*> decoded(texture_paths.size(), nullptr);
+	AssetLoader loader;
 	for (uint i = 0; i < texture_paths.size(); i++)
 	{
 		const std::string &path = texture_paths[i];
 		ivec2 &dimensions = texture_dimensions[i];
+		if (path.empty())
+			continue;
+		const AssetEntry *entry = archive.find(asset_name(path));
+		if (entry && entry->type == ASSET_TYPE::TEXTURE) {
+			dimensions = { (int)entry->width, (int)entry->height };
+			upload(i, archive.data(*entry));
+			continue;
+		}
 
-		stbi_uc *data;
-		data = stbi_load(path.c_str(), &dimensions.x, &dimensions.y, NULL, 4);
+		stbi_uc *&data = decoded[i];
+		loader.submit(path, [&path, &dimensions, &data]() {
+			data = stbi_load(path.c_str(), &dimensions.x, &dimensions.y, NULL, 4);
+		}, [i, &path, &data, &upload]() {
+			if (data == NULL)
+			{
+				const std::string message = "Could not load the file " + path + ".";
+				fprintf(stderr, "%s", message.c_str());
+				assert(false);
+			}
+			upload(i, data);
+		});
+	}
+	loader.wait_all();
+	gl_has_errors();
 
-		if (data == NULL)
-		{
-			const std::string message = "Could not load the file " + path + ".";
-			fprintf(stderr, "%s", message.c_str());
-			assert(false);
+	// text shares the score's digit art
+	std::array<const stbi_uc*, 10> digits;
+	std::array<ivec2, 10> digit_sizes;
+	for (uint d = 0; d < 10; d++) {
+		const uint i = (uint)TEXTURE_ASSET_ID::ZERO + d;
+		assert(atlas_data[i]);
+		digits[d] = atlas_data[i];
+		digit_sizes[d] = texture_dimensions[i];
+	}
+	GlyphAtlas glyph_atlas;
+	glyph_atlas.build(digits, digit_sizes);
+	glyphs = glyph_atlas.glyphs;
+	texture_dimensions[(uint)TEXTURE_ASSET_ID::GLYPHS] = glyph_atlas.size;
+	upload((uint)TEXTURE_ASSET_ID::GLYPHS, glyph_atlas.pixels.data());
+	gl_has_errors();
+
+	initializeTextureAtlas(atlas_data);
+	for (stbi_uc* data: decoded)
+		if (data)
+			stbi_image_free(data);
+}
+
+void RenderSystem::initializeTextureAtlas(const std::vector<const stbi_uc*>& atlas_data)
+{
+	// textures not in the atlas are sampled whole from their own handle
+	for (uint i = 0; i < texture_count; i++) {
+		texture_atlas_page[i] = texture_gl_handles[i];
+		texture_uv_rects[i] = { 0.f, 0.f, 1.f, 1.f };
+	}
+
+	std::vector<uint> packed;
+	std::vector<ivec2> sizes;
+	for (uint i = 0; i < texture_count; i++) {
+		if (atlas_data[i]) {
+			packed.push_back(i);
+			sizes.push_back(texture_dimensions[i]);
 		}
-		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dimensions.x, dimensions.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
+	std::vector<AtlasRect> rects;
+	int page_count = pack_atlas(sizes, rects);
+
+	atlas_pages.resize(page_count);
+	glGenTextures(page_count, atlas_pages.data());
+	std::vector<stbi_uc> pixels((size_t)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4);
+	for (int page = 0; page < page_count; page++) {
+		std::fill(pixels.begin(), pixels.end(), 0);
+		for (uint k = 0; k < packed.size(); k++) {
+			if (rects[k].page != page)
+				continue;
+			uint i = packed[k];
+			ivec2 size = texture_dimensions[i];
+			ivec2 position = rects[k].position;
+			for (int row = 0; row < size.y; row++)
+				std::copy(atlas_data[i] + (size_t)row * size.x * 4, atlas_data[i] + (size_t)(row + 1) * size.x * 4,
+						  pixels.begin() + ((size_t)(position.y + row) * ATLAS_PAGE_SIZE + position.x) * 4);
+			texture_atlas_page[i] = atlas_pages[page];
+			texture_uv_rects[i] = vec4(vec2(position), vec2(size)) / (float)ATLAS_PAGE_SIZE;
+		}
+		glBindTexture(GL_TEXTURE_2D, atlas_pages[page]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		gl_has_errors();
-		stbi_image_free(data);
 	}
-	gl_has_errors();
+	printf("Packed %zu sprites into %d atlas pages\n", packed.size(), page_count);
 }
 
 void RenderSystem::initializeGlEffects()
 {
-	for (uint i = 0; i < effect_paths.size(); i++)
-	{
-		const std::string vertex_shader_name = effect_paths[i] + ".vs.glsl";
-		const std::string fragment_shader_name = effect_paths[i] + ".fs.glsl";
+	ShaderCache cache;
+	cache.open(data_path() + "/shader_cache.bin");
 
-		bool is_valid = loadEffectFromFile(vertex_shader_name, fragment_shader_name, effects[i]);
-		assert(is_valid && (GLuint)effects[i] != 0);
+	// programs already built, keyed by source and defines
+	std::vector<std::string> program_keys;
+	for (uint i = 0; i < effect_sources.size(); i++)
+	{
+		const EffectSource &source = effect_sources[i];
+		std::string key = source.path;
+		for (const std::string &define : source.defines)
+			key += " " + define;
+
+		auto found = std::find(program_keys.begin(), program_keys.end(), key);
+		if (found == program_keys.end()) {
+			GLuint program = 0;
+			bool is_valid = loadEffectFromFile(source.path + ".vs.glsl", source.path + ".fs.glsl", program, source.defines, &cache);
+			assert(is_valid && program != 0);
+			programs.push_back(program);
+			program_keys.push_back(key);
+			found = program_keys.end() - 1;
+		}
+		effect_programs[i] = (uint8_t)(found - program_keys.begin());
+		effects[i] = programs[effect_programs[i]];
+		effect_locations[i] = reflect_effect(effects[i]);
 	}
+	printf("Built %zu programs for %d effects\n", programs.size(), effect_count);
+	cache.report();
+	cache.close();
+}
+
+EffectLocations reflect_effect(GLuint program)
+{
+	EffectLocations locations;
+	locations.transform = glGetUniformLocation(program, "transform");
+	locations.projection = glGetUniformLocation(program, "projection");
+	locations.fcolor = glGetUniformLocation(program, "fcolor");
+	locations.uv_rect = glGetUniformLocation(program, "uv_rect");
+	locations.params = glGetUniformLocation(program, "params");
+	locations.screen_texture = glGetUniformLocation(program, "screen_texture");
+	locations.dialogue_texture = glGetUniformLocation(program, "dialogue_texture");
+	locations.post_params = glGetUniformBlockIndex(program, "PostParams");
+	locations.time = glGetUniformLocation(program, "time");
+	gl_has_errors();
+	return locations;
+}
+
+// Attribute layout of each vertex type, recorded in the currently bound vertex array object
+static void set_vertex_format(const TexturedVertex *)
+{
+	glEnableVertexAttribArray(ATTRIB_IN_POSITION);
+	glVertexAttribPointer(ATTRIB_IN_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void *)0);
+	glEnableVertexAttribArray(ATTRIB_IN_TEXCOORD);
+	glVertexAttribPointer(ATTRIB_IN_TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(TexturedVertex), (void *)sizeof(vec3));
+}
+
+static void set_vertex_format(const ColoredVertex *)
+{
+	glEnableVertexAttribArray(ATTRIB_IN_POSITION);
+	glVertexAttribPointer(ATTRIB_IN_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)0);
+	glEnableVertexAttribArray(ATTRIB_IN_COLOR);
+	glVertexAttribPointer(ATTRIB_IN_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)sizeof(vec3));
+}
+
+static void set_vertex_format(const vec3 *)
+{
+	glEnableVertexAttribArray(ATTRIB_IN_POSITION);
+	glVertexAttribPointer(ATTRIB_IN_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void *)0);
 }
 
 // One could merge the following two functions as a template function...
 template <class T>
 void RenderSystem::bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices)
 {
+	// The index buffer binding is part of the vertex array state, so bind it first
+	glBindVertexArray(vertex_arrays[(uint)gid]);
 	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(uint)gid]);
 	glBufferData(GL_ARRAY_BUFFER,
 				 sizeof(vertices[0]) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
@@ -116,6 +274,11 @@ void RenderSystem::bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
 				 sizeof(indices[0]) * indices.size(), indices.data(), GL_STATIC_DRAW);
 	gl_has_errors();
+	index_counts[(uint)gid] = (GLsizei)indices.size();
+
+	set_vertex_format(vertices.data());
+	glBindVertexArray(0);
+	gl_has_errors();
 }
 
 void RenderSystem::initializeGlMeshes()
@@ -143,10 +306,22 @@ void RenderSystem::initializeCollisionMeshes()
 		// Initialize meshes
 		GEOMETRY_BUFFER_ID geom_index = collision_mesh_paths[i].first;
 		std::string name = collision_mesh_paths[i].second;
-		CollisionMesh::loadFromOBJFile(name,
-			collisionMeshes[(int)geom_index].vertices,
-			collisionMeshes[(int)geom_index].edges,
-			collisionMeshes[(int)geom_index].original_size);
+		CollisionMesh &mesh = collisionMeshes[(int)geom_index];
+		const AssetEntry *entry = asset_archive().find(asset_name(name));
+		if (entry && entry->type == ASSET_TYPE::COLLISION_MESH) {
+			const unsigned char *data = asset_archive().data(*entry);
+			memcpy(&mesh.original_size, data, sizeof(vec2));
+			data += sizeof(vec2);
+			mesh.vertices.resize(entry->width);
+			memcpy(mesh.vertices.data(), data, sizeof(ColoredVertex) * entry->width);
+			data += sizeof(ColoredVertex) * entry->width;
+			const int32_t *indices = (const int32_t *)data;
+			mesh.edges.resize(entry->height);
+			for (uint k = 0; k < entry->height; k++)
+				mesh.edges[k] = { indices[2 * k], indices[2 * k + 1] };
+		} else {
+			CollisionMesh::loadFromOBJFile(name, mesh.vertices, mesh.edges, mesh.original_size);
+		}
 		if (geom_index == GEOMETRY_BUFFER_ID::SPRITE) {
 			collisionMeshes[(int)geom_index].is_sprite = true;
 		}
@@ -159,6 +334,8 @@ void RenderSystem::initializeGlGeometryBuffers()
 	glGenBuffers((GLsizei)vertex_buffers.size(), vertex_buffers.data());
 	// Index Buffer creation.
 	glGenBuffers((GLsizei)index_buffers.size(), index_buffers.data());
+	// Vertex array creation.
+	glGenVertexArrays((GLsizei)vertex_arrays.size(), vertex_arrays.data());
 
 	// Index and Vertex buffer data initialization.
 	initializeGlMeshes();
@@ -215,23 +392,124 @@ void RenderSystem::initializeGlGeometryBuffers()
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE, screen_vertices, screen_indices);
 }
 
+void RenderSystem::initializeSpriteBatch()
+{
+	glGenBuffers(1, &sprite_instance_buffer);
+	gl_has_errors();
+
+	// Same per vertex data as the sprite geometry
+	glGenVertexArrays(1, &sprite_instance_vao);
+	glBindVertexArray(sprite_instance_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffers[(GLuint)GEOMETRY_BUFFER_ID::SPRITE]);
+	set_vertex_format((const TexturedVertex *)nullptr);
+
+	// Per instance data, the buffer is refilled on every flush but keeps its name
+	glBindBuffer(GL_ARRAY_BUFFER, sprite_instance_buffer);
+	for (GLuint column = 0; column < 3; column++) {
+		glEnableVertexAttribArray(ATTRIB_IN_TRANSFORM + column);
+		glVertexAttribPointer(ATTRIB_IN_TRANSFORM + column, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+							  (void *)(offsetof(SpriteInstance, transform) + column * sizeof(vec3)));
+		glVertexAttribDivisor(ATTRIB_IN_TRANSFORM + column, 1);
+	}
+	glEnableVertexAttribArray(ATTRIB_IN_TINT);
+	glVertexAttribPointer(ATTRIB_IN_TINT, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void *)offsetof(SpriteInstance, color));
+	glVertexAttribDivisor(ATTRIB_IN_TINT, 1);
+	glEnableVertexAttribArray(ATTRIB_IN_UV_RECT);
+	glVertexAttribPointer(ATTRIB_IN_UV_RECT, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void *)offsetof(SpriteInstance, uv_rect));
+	glVertexAttribDivisor(ATTRIB_IN_UV_RECT, 1);
+	glEnableVertexAttribArray(ATTRIB_IN_PARAMS);
+	glVertexAttribPointer(ATTRIB_IN_PARAMS, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void *)offsetof(SpriteInstance, params));
+	glVertexAttribDivisor(ATTRIB_IN_PARAMS, 1);
+	glBindVertexArray(0);
+	gl_has_errors();
+	// the largest levels have a few hundred sprites on screen
+	sprite_instances.reserve(512);
+}
+
+void RenderSystem::initializeStream()
+{
+	stream_buffer.init(sizeof(TexturedVertex) * STREAM_MAX_VERTICES);
+
+	// Every region is read through the same pointers, draws pick theirs with the first vertex
+	glGenVertexArrays(1, &stream_vao);
+	glBindVertexArray(stream_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.buffer);
+	set_vertex_format((const TexturedVertex *)nullptr);
+	glBindVertexArray(0);
+	gl_has_errors();
+	printf("Streaming vertices through %s\n", stream_buffer.persistent ? "a persistently mapped ring" : "orphaned buffers");
+}
+
+void RenderSystem::initializePostProcess()
+{
+	glGenBuffers(1, &post_params_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, post_params_buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(PostParams), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, POST_PARAMS_BINDING, post_params_buffer);
+	gl_has_errors();
+
+	// Program state, set here rather than in the shader so cached binaries need nothing else
+	const EffectLocations &locations = effect_locations[(GLuint)EFFECT_ASSET_ID::SCREEN];
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::SCREEN];
+	assert(locations.post_params != GL_INVALID_INDEX);
+	glUniformBlockBinding(program, locations.post_params, POST_PARAMS_BINDING);
+	glUseProgram(program);
+	glUniform1i(locations.screen_texture, 0);
+	glUniform1i(locations.dialogue_texture, 1);
+	glUseProgram(0);
+	gl_has_errors();
+}
+
+void RenderSystem::initializeParallax()
+{
+	std::array<GLint, PARALLAX_LAYER_COUNT> units;
+	std::array<vec4, PARALLAX_LAYER_COUNT> rects;
+	std::array<vec4, PARALLAX_LAYER_COUNT> scrolls;
+	for (uint i = 0; i < PARALLAX_LAYER_COUNT; i++) {
+		const ParallaxLayer &layer = parallax_layers[i];
+		units[i] = (GLint)i;
+		rects[i] = vec4(layer.origin, layer.size);
+		scrolls[i] = vec4(layer.velocity, layer.repeat);
+	}
+
+	// Program state, set here rather than in the shader so cached binaries need nothing else
+	const GLuint program = effects[(GLuint)EFFECT_ASSET_ID::PARALLAX];
+	glUseProgram(program);
+	glUniform1iv(glGetUniformLocation(program, "layers"), PARALLAX_LAYER_COUNT, units.data());
+	glUniform4fv(glGetUniformLocation(program, "layer_rects"), PARALLAX_LAYER_COUNT, (float *)rects.data());
+	glUniform4fv(glGetUniformLocation(program, "layer_scrolls"), PARALLAX_LAYER_COUNT, (float *)scrolls.data());
+	glUniform2f(glGetUniformLocation(program, "view_size"), (float)window_width_px, (float)window_height_px);
+	glUseProgram(0);
+	gl_has_errors();
+}
+
 RenderSystem::~RenderSystem()
 {
+	// the context has to be back on this thread
+	stopRenderThread();
+
 	// Don't need to free gl resources since they last for as long as the program,
 	// but it's polite to clean after yourself.
 	glDeleteBuffers((GLsizei)vertex_buffers.size(), vertex_buffers.data());
 	glDeleteBuffers((GLsizei)index_buffers.size(), index_buffers.data());
+	glDeleteBuffers(1, &sprite_instance_buffer);
+	glDeleteBuffers(1, &post_params_buffer);
+	glDeleteVertexArrays((GLsizei)vertex_arrays.size(), vertex_arrays.data());
+	glDeleteVertexArrays(1, &sprite_instance_vao);
+	glDeleteVertexArrays(1, &stream_vao);
+	stream_buffer.destroy();
 	glDeleteTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
+	glDeleteTextures((GLsizei)atlas_pages.size(), atlas_pages.data());
 	glDeleteTextures(1, &off_screen_render_buffer_color);
-	glDeleteRenderbuffers(1, &off_screen_render_buffer_depth);
+	glDeleteTextures(1, &dialogue_texture);
 	gl_has_errors();
 
-	for (uint i = 0; i < effect_count; i++)
-	{
-		glDeleteProgram(effects[i]);
-	}
+	for (GLuint program : programs)
+		glDeleteProgram(program);
 	// delete allocated resources
 	glDeleteFramebuffers(1, &frame_buffer);
+	glDeleteFramebuffers(1, &dialogue_frame_buffer);
 	gl_has_errors();
 
 	// remove all entities created by the render system
@@ -244,28 +522,44 @@ bool RenderSystem::initScreenTexture()
 {
 	registry.screenStates.emplace(screen_state_entity);
 
-	int framebuffer_width, framebuffer_height;
-	glfwGetFramebufferSize(const_cast<GLFWwindow *>(window), &framebuffer_width, &framebuffer_height); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
-
+	// Color only, nothing is depth tested. The dialogue layer has a target of its own
 	glGenTextures(1, &off_screen_render_buffer_color);
-	glBindTexture(GL_TEXTURE_2D, off_screen_render_buffer_color);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, framebuffer_width, framebuffer_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	gl_has_errors();
+	glGenTextures(1, &dialogue_texture);
+	glGenFramebuffers(1, &dialogue_frame_buffer);
+	ivec2 framebuffer_size;
+	glfwGetFramebufferSize(window, &framebuffer_size.x, &framebuffer_size.y);
+	resizeRenderTargets(renderTargetSize(render_resolution, framebuffer_size), upscale_filter);
 
-	glGenRenderbuffers(1, &off_screen_render_buffer_depth);
-	glBindRenderbuffer(GL_RENDERBUFFER, off_screen_render_buffer_depth);
+	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, off_screen_render_buffer_color, 0);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, framebuffer_width, framebuffer_height);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, off_screen_render_buffer_depth);
-	gl_has_errors();
-
 	assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, dialogue_frame_buffer);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, dialogue_texture, 0);
+	assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
+	gl_has_errors();
 
 	return true;
 }
 
+void RenderSystem::resizeRenderTargets(ivec2 size, UPSCALE_FILTER upscale_filter)
+{
+	// The framebuffers keep their attachments, only the storage behind them changes
+	const GLint filter = upscale_filter == UPSCALE_FILTER::NEAREST ? GL_NEAREST : GL_LINEAR;
+	for (GLuint texture : { off_screen_render_buffer_color, dialogue_texture }) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	gl_has_errors();
+	screen_texture_size = size;
+	screen_texture_filter = upscale_filter;
+	printf("Rendering the scene at %dx%d\n", size.x, size.y);
+}
+
 bool gl_compile_shader(GLuint shader)
 {
 	glCompileShader(shader);
@@ -289,25 +583,78 @@ bool gl_compile_shader(GLuint shader)
 	return true;
 }
 
+// Sources included by one shader, past this it is assumed they include each other
+const int SHADER_INCLUDE_DEPTH = 8;
+
+static bool preprocess_shader_file(const std::string &path, const std::vector<std::string> *defines, int depth, std::string &out_source)
+{
+	if (depth > SHADER_INCLUDE_DEPTH) {
+		fprintf(stderr, "Shader includes nested too deep at %s\n", path.c_str());
+		return false;
+	}
+	std::ifstream is(path);
+	if (!is.good()) {
+		fprintf(stderr, "Failed to load shader file %s\n", path.c_str());
+		return false;
+	}
+	const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+	std::string line;
+	int line_number = 0;
+	while (std::getline(is, line)) {
+		line_number++;
+		size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+			size_t open = line.find('"', start);
+			size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos) {
+				fprintf(stderr, "%s:%d: malformed #include\n", path.c_str(), line_number);
+				return false;
+			}
+			if (!preprocess_shader_file(directory + line.substr(open + 1, close - open - 1), nullptr, depth + 1, out_source))
+				return false;
+			// keeps compiler errors pointing at the right line of this file
+			out_source += "#line " + std::to_string(line_number + 1) + "\n";
+			continue;
+		}
+		out_source += line + "\n";
+		if (defines && start != std::string::npos && line.compare(start, 8, "#version") == 0) {
+			for (const std::string &define : *defines)
+				out_source += "#define " + define + "\n";
+			out_source += "#line " + std::to_string(line_number + 1) + "\n";
+		}
+	}
+	return true;
+}
+
+bool preprocessShader(const std::string &path, const std::vector<std::string> &defines, std::string &out_source)
+{
+	out_source.clear();
+	return preprocess_shader_file(path, &defines, 0, out_source);
+}
+
 bool loadEffectFromFile(
-	const std::string &vs_path, const std::string &fs_path, GLuint &out_program)
+	const std::string &vs_path, const std::string &fs_path, GLuint &out_program,
+	const std::vector<std::string> &defines, ShaderCache *cache)
 {
-	// Opening files
-	std::ifstream vs_is(vs_path);
-	std::ifstream fs_is(fs_path);
-	if (!vs_is.good() || !fs_is.good())
+	// Reading sources
+	std::string vs_str, fs_str;
+	if (!preprocessShader(vs_path, defines, vs_str) || !preprocessShader(fs_path, defines, fs_str))
 	{
 		fprintf(stderr, "Failed to load shader files %s, %s", vs_path.c_str(), fs_path.c_str());
 		assert(false);
 		return false;
 	}
 
-	// Reading sources
-	std::stringstream vs_ss, fs_ss;
-	vs_ss << vs_is.rdbuf();
-	fs_ss << fs_is.rdbuf();
-	std::string vs_str = vs_ss.str();
-	std::string fs_str = fs_ss.str();
+	uint64_t cache_key = 0;
+	if (cache) {
+		cache_key = cache->key(vs_str, fs_str);
+		out_program = cache->load(cache_key);
+		if (out_program != 0)
+			return true;
+	}
+	auto build_start = std::chrono::high_resolution_clock::now();
+
 	const char *vs_src = vs_str.c_str();
 	const char *fs_src = fs_str.c_str();
 	GLsizei vs_len = (GLsizei)vs_str.size();
@@ -337,6 +684,12 @@ bool loadEffectFromFile(
 	out_program = glCreateProgram();
 	glAttachShader(out_program, vertex);
 	glAttachShader(out_program, fragment);
+	if (cache && cache->is_enabled())
+		glProgramParameteri(out_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	// Fixed locations, explicit layout qualifiers in a shader still take precedence
+	glBindAttribLocation(out_program, ATTRIB_IN_POSITION, "in_position");
+	glBindAttribLocation(out_program, ATTRIB_IN_TEXCOORD, "in_texcoord");
+	glBindAttribLocation(out_program, ATTRIB_IN_COLOR, "in_color");
 	glLinkProgram(out_program);
 	gl_has_errors();
 
@@ -365,5 +718,9 @@ bool loadEffectFromFile(
 	glDeleteShader(fragment);
 	gl_has_errors();
 
+	if (cache) {
+		auto build_time = std::chrono::high_resolution_clock::now() - build_start;
+		cache->store(cache_key, out_program, (float)std::chrono::duration_cast<std::chrono::microseconds>(build_time).count() / 1000.f);
+	}
 	return true;
 }
@@ -0,0 +1,145 @@
+// internal
+#include "shader_cache.hpp"
+
+// stlib
+#include <chrono>
+#include <cstdio>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static float ms_since(Clock::time_point start)
+{
+	return (float)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.f;
+}
+
+// FNV-1a, continuing from hash
+static uint64_t hash_bytes(const char *data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+void ShaderCache::open(const std::string &path)
+{
+	this->path = path;
+	// Program binaries are core in 4.1, the driver may still support no format at all
+	GLint format_count = 0;
+	if (gl3w_is_supported(4, 1) || gl_has_extension("GL_ARB_get_program_binary"))
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+	enabled = format_count > 0;
+	if (!enabled) {
+		printf("Program binaries are not supported, shaders are compiled from source\n");
+		return;
+	}
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const char *value = (const char *)glGetString(name);
+		driver += value ? value : "";
+		driver += "\n";
+	}
+	gl_has_errors();
+
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file)
+		return;
+	ShaderCacheHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION) {
+		fprintf(stderr, "Ignoring the shader cache %s, it was written by another version\n", path.c_str());
+		fclose(file);
+		return;
+	}
+	for (uint32_t i = 0; i < header.entry_count; i++) {
+		ShaderCacheEntry entry;
+		if (fread(&entry, sizeof(entry), 1, file) != 1)
+			break;
+		Binary binary = { (GLenum)entry.format, entry.build_ms, std::vector<char>(entry.size) };
+		if (fread(binary.data.data(), 1, entry.size, file) != entry.size)
+			break;
+		binaries[entry.key] = std::move(binary);
+	}
+	fclose(file);
+}
+
+void ShaderCache::close()
+{
+	if (!dirty)
+		return;
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		fprintf(stderr, "Could not write the shader cache %s\n", path.c_str());
+		return;
+	}
+	ShaderCacheHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, (uint32_t)binaries.size(), 0 };
+	fwrite(&header, sizeof(header), 1, file);
+	for (const auto &it : binaries) {
+		ShaderCacheEntry entry = { it.first, (uint32_t)it.second.format, (uint32_t)it.second.data.size(), it.second.build_ms, 0 };
+		fwrite(&entry, sizeof(entry), 1, file);
+		fwrite(it.second.data.data(), 1, it.second.data.size(), file);
+	}
+	if (ferror(file))
+		fprintf(stderr, "Could not write the shader cache %s\n", path.c_str());
+	fclose(file);
+	dirty = false;
+}
+
+uint64_t ShaderCache::key(const std::string &vs_source, const std::string &fs_source) const
+{
+	uint64_t hash = hash_bytes(driver.data(), driver.size());
+	hash = hash_bytes(vs_source.data(), vs_source.size() + 1, hash); // with the terminator, splitting the sources differently changes the key
+	return hash_bytes(fs_source.data(), fs_source.size(), hash);
+}
+
+GLuint ShaderCache::load(uint64_t key)
+{
+	auto found = binaries.find(key);
+	if (!enabled || found == binaries.end()) {
+		misses++;
+		return 0;
+	}
+	Clock::time_point start = Clock::now();
+	const Binary &binary = found->second;
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, binary.format, binary.data.data(), (GLsizei)binary.data.size());
+	GLint is_linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+	// glProgramBinary reports a format the driver no longer accepts as an error, it is not a bug
+	while (glGetError() != GL_NO_ERROR)
+		;
+	if (is_linked == GL_FALSE) {
+		// stale after a driver change the version string did not show, it is replaced once rebuilt
+		glDeleteProgram(program);
+		binaries.erase(found);
+		misses++;
+		return 0;
+	}
+	hits++;
+	saved_ms += binary.build_ms - ms_since(start);
+	return program;
+}
+
+void ShaderCache::store(uint64_t key, GLuint program, float build_ms)
+{
+	if (!enabled)
+		return;
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	Binary binary = { 0, build_ms, std::vector<char>(length) };
+	glGetProgramBinary(program, length, nullptr, &binary.format, binary.data.data());
+	if (gl_has_errors())
+		return;
+	binaries[key] = std::move(binary);
+	dirty = true;
+}
+
+void ShaderCache::report() const
+{
+	if (!enabled)
+		return;
+	uint lookups = hits + misses;
+	printf("Shader cache: %u of %u programs loaded from binaries (%.0f%%), saving %.1f ms\n",
+		   hits, lookups, lookups ? 100.f * hits / lookups : 0.f, saved_ms);
+}
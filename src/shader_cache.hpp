@@ -0,0 +1,75 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Layout: header, then for every program a ShaderCacheEntry followed by its binary
+const uint32_t SHADER_CACHE_MAGIC = 0x43535454; // "TTSC"
+// Bump when something baked into the binaries changes outside of the sources, like the attribute bindings
+const uint32_t SHADER_CACHE_VERSION = 1;
+
+struct ShaderCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t reserved;
+};
+
+struct ShaderCacheEntry
+{
+	uint64_t key;
+	uint32_t format;
+	uint32_t size;
+	// how long compiling and linking took when the binary was stored
+	float build_ms;
+	uint32_t reserved;
+};
+
+// Linked program binaries from previous runs, so effects whose sources and driver have not changed
+// skip compiling and linking. Needs a driver that hands out program binaries, without one every
+// lookup misses and nothing is written.
+class ShaderCache
+{
+public:
+	// Reads the cache file if there is one
+	void open(const std::string &path);
+	// Writes the cache back if anything was added
+	void close();
+	bool is_enabled() const { return enabled; }
+
+	// Key of the program built from the sources, covering the driver so an update invalidates it
+	uint64_t key(const std::string &vs_source, const std::string &fs_source) const;
+	// Creates a program from the binary stored under the key, 0 on a miss or when the driver rejects it
+	GLuint load(uint64_t key);
+	// Keeps the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	void store(uint64_t key, GLuint program, float build_ms);
+
+	// Prints the hit rate and the compile time the hits saved
+	void report() const;
+
+private:
+	struct Binary
+	{
+		GLenum format;
+		float build_ms;
+		std::vector<char> data;
+	};
+	std::unordered_map<uint64_t, Binary> binaries;
+
+	std::string path;
+	// vendor, renderer and version of the context
+	std::string driver;
+	bool enabled = false;
+	bool dirty = false;
+
+	uint hits = 0;
+	uint misses = 0;
+	float saved_ms = 0.f;
+};
@@ -1,4 +1,6 @@
 #include "sound_utils.hpp"
+#include "asset_loader.hpp"
+#include "asset_archive.hpp"
 
 // music references
 Mix_Music *background_music;
@@ -26,32 +28,59 @@ uint init_sound()
 	background_music = Mix_LoadMUS(audio_path("music.wav").c_str());
 	dialogue_background_music = Mix_LoadMUS(audio_path("dialogue_bg_music.wav").c_str());
 	main_menu_background_music = Mix_LoadMUS(audio_path("main_menu_bg_music.wav").c_str());
-	sound_effects.push_back(Mix_LoadWAV(audio_path("hero_hurt.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("hero_jump.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("sword_swing.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("bow_shoot.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("bow_loading.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("staff_fire.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("recharge.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("swoosh.wav").c_str()));
-	//Sound Effect by <a href="https://pixabay.com/users/jigokukarano_sisya-39731529/?utm_source=link-attribution&utm_medium=referral&utm_campaign=music&utm_content=168857">jigokukarano_sisya</a> from <a href="https://pixabay.com/sound-effects//?utm_source=link-attribution&utm_medium=referral&utm_campaign=music&utm_content=168857">Pixabay</a>
-	sound_effects.push_back(Mix_LoadWAV(audio_path("charge.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("explosion.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("laser_fire.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("laser_reload.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("heal.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("pickaxe.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("dash.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("equipment_drop.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("button_click.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("teleport.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("hades_laugh.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("water_ball_shoot.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("boss_slam.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("boss_teleport.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("boss_summon.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("boss_death.wav").c_str()));
-	sound_effects.push_back(Mix_LoadWAV(audio_path("bell.wav").c_str()));
+
+	// in SOUND_EFFECT order
+	const std::vector<std::string> effect_files = {
+		"hero_hurt.wav",
+		"hero_jump.wav",
+		"sword_swing.wav",
+		"bow_shoot.wav",
+		"bow_loading.wav",
+		"staff_fire.wav",
+		"recharge.wav",
+		"swoosh.wav",
+		//Sound Effect by <a href="https://pixabay.com/users/jigokukarano_sisya-39731529/?utm_source=link-attribution&utm_medium=referral&utm_campaign=music&utm_content=168857">jigokukarano_sisya</a> from <a href="https://pixabay.com/sound-effects//?utm_source=link-attribution&utm_medium=referral&utm_campaign=music&utm_content=168857">Pixabay</a>
+		"charge.wav",
+		"explosion.wav",
+		"laser_fire.wav",
+		"laser_reload.wav",
+		"heal.wav",
+		"pickaxe.wav",
+		"dash.wav",
+		"equipment_drop.wav",
+		"button_click.wav",
+		"teleport.wav",
+		"hades_laugh.wav",
+		"water_ball_shoot.wav",
+		"boss_slam.wav",
+		"boss_teleport.wav",
+		"boss_summon.wav",
+		"boss_death.wav",
+		"bell.wav"
+	};
+	// Packed effects are already PCM in the device format and are played from the archive in place,
+	// which only works if the device was opened with the format they were baked to
+	int frequency, channels;
+	Uint16 format;
+	Mix_QuerySpec(&frequency, &format, &channels);
+	const bool use_archive = frequency == ASSET_AUDIO_FREQUENCY && format == AUDIO_S16SYS && channels == ASSET_AUDIO_CHANNELS;
+	const AssetArchive &archive = asset_archive();
+
+	// Decoding a chunk only reads the format of the opened device, so they can be decoded in parallel
+	sound_effects.assign(effect_files.size(), nullptr);
+	AssetLoader loader;
+	for (uint i = 0; i < effect_files.size(); i++) {
+		const std::string path = audio_path(effect_files[i]);
+		const AssetEntry *entry = use_archive ? archive.find(asset_name(path)) : nullptr;
+		if (entry && entry->type == ASSET_TYPE::SOUND) {
+			sound_effects[i] = Mix_QuickLoad_RAW((Uint8 *)archive.data(*entry), (Uint32)entry->size);
+			continue;
+		}
+		loader.submit(path, [path, i]() {
+			sound_effects[i] = Mix_LoadWAV(path.c_str());
+		});
+	}
+	loader.wait_all();
 
 	if (background_music == nullptr || dialogue_background_music == nullptr || std::any_of(sound_effects.begin(), sound_effects.end(), [](Mix_Chunk *effect)
 												   { return effect == nullptr; }))
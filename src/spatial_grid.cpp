@@ -0,0 +1,93 @@
+// internal
+#include "spatial_grid.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+
+ivec2 SpatialGrid::cell_of(vec2 pos)
+{
+	ivec2 cell = ivec2(floor((pos - SPATIAL_GRID_ORIGIN) / SPATIAL_GRID_CELL_SIZE));
+	return clamp(cell, ivec2(0), ivec2(SPATIAL_GRID_COLUMNS - 1, SPATIAL_GRID_ROWS - 1));
+}
+
+static uint spatial_categories(Entity entity)
+{
+	if (registry.players.has(entity))
+		return SPATIAL_PLAYER;
+	if (registry.blocks.has(entity))
+		return SPATIAL_BLOCK;
+	if (registry.enemies.has(entity))
+		return SPATIAL_ENEMY;
+	if (registry.projectiles.has(entity) || registry.bullets.has(entity) || registry.rockets.has(entity) || registry.spitterBullets.has(entity))
+		return SPATIAL_PROJECTILE;
+	return SPATIAL_OTHER;
+}
+
+void SpatialGrid::build()
+{
+	entries.clear();
+	auto& mesh_container = registry.collisionMeshPtrs;
+	for (uint i = 0; i < mesh_container.size(); i++) {
+		Entity entity = mesh_container.entities[i];
+		Motion& motion = registry.motions.get(entity);
+		// the box test in collides ignores rotation while the precise test applies it, cover both
+		vec2 half = abs(motion.scale) / 2.f;
+		float c = abs(cos(motion.angle));
+		float s = abs(sin(motion.angle));
+		vec2 rotated = { c * half.x + s * half.y, s * half.x + c * half.y };
+		vec2 extent = max(half, rotated) + vec2(length(motion.positionOffset));
+		entries.push_back({ entity, motion.position - extent, motion.position + extent, spatial_categories(entity) });
+	}
+
+	// counting sort of the entries into their cells
+	const int cell_count = SPATIAL_GRID_COLUMNS * SPATIAL_GRID_ROWS;
+	cell_start.assign(cell_count + 1, 0);
+	for (const Entry& entry: entries) {
+		ivec2 lo = cell_of(entry.min);
+		ivec2 hi = cell_of(entry.max);
+		for (int y = lo.y; y <= hi.y; y++)
+			for (int x = lo.x; x <= hi.x; x++)
+				cell_start[y * SPATIAL_GRID_COLUMNS + x + 1]++;
+	}
+	for (int cell = 0; cell < cell_count; cell++)
+		cell_start[cell + 1] += cell_start[cell];
+
+	items.resize(cell_start[cell_count]);
+	cell_fill.assign(cell_start.begin(), cell_start.end() - 1);
+	for (uint i = 0; i < entries.size(); i++) {
+		ivec2 lo = cell_of(entries[i].min);
+		ivec2 hi = cell_of(entries[i].max);
+		for (int y = lo.y; y <= hi.y; y++)
+			for (int x = lo.x; x <= hi.x; x++)
+				items[cell_fill[y * SPATIAL_GRID_COLUMNS + x]++] = i;
+	}
+
+	visit_mark.assign(entries.size(), 0);
+	visit_stamp = 0;
+	generation++;
+}
+
+void SpatialGrid::overlapping_pairs(std::vector<std::pair<uint, uint>>& pairs) const
+{
+	pairs.clear();
+	const int cell_count = SPATIAL_GRID_COLUMNS * SPATIAL_GRID_ROWS;
+	for (int cell = 0; cell < cell_count; cell++) {
+		for (uint a = cell_start[cell]; a < cell_start[cell + 1]; a++) {
+			const Entry& entry_a = entries[items[a]];
+			for (uint b = a + 1; b < cell_start[cell + 1]; b++) {
+				const Entry& entry_b = entries[items[b]];
+				if (entry_a.min.x > entry_b.max.x || entry_a.max.x < entry_b.min.x || entry_a.min.y > entry_b.max.y || entry_a.max.y < entry_b.min.y)
+					continue;
+				// a pair sharing several cells is only reported by the cell holding the corner of their overlap
+				ivec2 owner = cell_of(max(entry_a.min, entry_b.min));
+				if (owner.y * SPATIAL_GRID_COLUMNS + owner.x != cell)
+					continue;
+				// items within a cell are in entry order, so items[a] < items[b]
+				pairs.push_back({ items[a], items[b] });
+			}
+		}
+	}
+	// keep the order of the old all pairs loop, collision handling depends on it
+	std::sort(pairs.begin(), pairs.end());
+}
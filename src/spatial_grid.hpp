@@ -0,0 +1,93 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+
+// stlib
+#include <vector>
+
+// Area covered by the grid, entities outside of it are kept in the border cells
+const vec2 SPATIAL_GRID_ORIGIN = { -400.f, -400.f };
+const float SPATIAL_GRID_CELL_SIZE = 100.f;
+const int SPATIAL_GRID_COLUMNS = 24;
+const int SPATIAL_GRID_ROWS = 20;
+
+// What an indexed entity is, so queries can filter without touching the registry
+enum SPATIAL_CATEGORY : uint {
+	SPATIAL_PLAYER = 1 << 0,
+	SPATIAL_BLOCK = 1 << 1,
+	SPATIAL_ENEMY = 1 << 2,
+	SPATIAL_PROJECTILE = 1 << 3,
+	SPATIAL_OTHER = 1 << 4,
+	SPATIAL_ALL = (1 << 5) - 1
+};
+
+// Uniform grid over every collidable entity, rebuilt by the physics system each step.
+// Cells are stored back to back (a cell's entries are items[cell_start[c]..cell_start[c + 1]])
+// so a rebuild does not allocate once the buffers have grown.
+class SpatialGrid
+{
+public:
+	struct Entry
+	{
+		Entity entity;
+		// conservative bounds, covering rotation and position offsets
+		vec2 min;
+		vec2 max;
+		uint categories;
+	};
+
+	// Re-indexes every entity with a collision mesh, entries follow registry.collisionMeshPtrs order
+	void build();
+
+	// Calls visit(entry index) once for every entry whose bounds overlap the box
+	template<typename F>
+	void query_box(vec2 min, vec2 max, uint category_mask, F visit) const;
+
+	// Index pairs (i < j) of entries whose bounds overlap, sorted by i then j
+	void overlapping_pairs(std::vector<std::pair<uint, uint>>& pairs) const;
+
+	const std::vector<Entry>& get_entries() const { return entries; }
+	// Bumped on every build, lets users cache query results per step
+	uint get_generation() const { return generation; }
+
+	static ivec2 cell_of(vec2 pos);
+
+private:
+	std::vector<Entry> entries;
+	std::vector<uint> cell_start;
+	std::vector<uint> items;
+	// scratch for build, and for making sure entries spanning cells are only visited once
+	std::vector<uint> cell_fill;
+	mutable std::vector<uint> visit_mark;
+	mutable uint visit_stamp = 0;
+	uint generation = 0;
+};
+
+template<typename F>
+void SpatialGrid::query_box(vec2 min, vec2 max, uint category_mask, F visit) const
+{
+	if (entries.empty())
+		return;
+	if (++visit_stamp == 0) {
+		std::fill(visit_mark.begin(), visit_mark.end(), 0);
+		visit_stamp = 1;
+	}
+	ivec2 lo = cell_of(min);
+	ivec2 hi = cell_of(max);
+	for (int y = lo.y; y <= hi.y; y++) {
+		for (int x = lo.x; x <= hi.x; x++) {
+			int cell = y * SPATIAL_GRID_COLUMNS + x;
+			for (uint k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+				uint index = items[k];
+				const Entry& entry = entries[index];
+				if (visit_mark[index] == visit_stamp || !(entry.categories & category_mask))
+					continue;
+				visit_mark[index] = visit_stamp;
+				if (entry.min.x <= max.x && entry.max.x >= min.x && entry.min.y <= max.y && entry.max.y >= min.y)
+					visit(index);
+			}
+		}
+	}
+}
@@ -0,0 +1,92 @@
+// internal
+#include "stream_buffer.hpp"
+
+// stlib
+#include <cstring>
+
+// Buffer storage is core in 4.4, we ask for a 3.3 context so it usually comes as the extension
+static bool has_buffer_storage()
+{
+	return gl3w_is_supported(4, 4) || gl_has_extension("GL_ARB_buffer_storage");
+}
+
+void StreamBuffer::init(GLsizeiptr region_size)
+{
+	this->region_size = region_size;
+	const GLsizeiptr total_size = region_size * STREAM_BUFFER_REGIONS;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	persistent = has_buffer_storage();
+	if (persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, total_size, nullptr, flags);
+		mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, total_size, flags);
+		if (!mapped) {
+			fprintf(stderr, "Failed to map the stream buffer, falling back to orphaning\n");
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			persistent = false;
+		}
+	}
+	if (!persistent)
+		glBufferData(GL_ARRAY_BUFFER, region_size, nullptr, GL_STREAM_DRAW);
+	gl_has_errors();
+}
+
+void StreamBuffer::destroy()
+{
+	for (GLsync &sync : fences) {
+		if (sync)
+			glDeleteSync(sync);
+		sync = nullptr;
+	}
+	if (mapped) {
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapped = nullptr;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+GLintptr StreamBuffer::upload(const void *data, GLsizeiptr size)
+{
+	if (size > region_size) {
+		fprintf(stderr, "Stream buffer overflow, dropping %ld bytes\n", (long)(size - region_size));
+		size = region_size;
+	}
+
+	if (!persistent) {
+		// the old storage lives on until the draws using it are done
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, region_size, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+		gl_has_errors();
+		return 0;
+	}
+
+	region = (region + 1) % STREAM_BUFFER_REGIONS;
+	GLsync &sync = fences[region];
+	if (sync) {
+		// three frames behind, this practically never waits
+		GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		if (result == GL_WAIT_FAILED)
+			fprintf(stderr, "Waiting on the stream buffer fence failed\n");
+		glDeleteSync(sync);
+		sync = nullptr;
+	}
+	GLintptr offset = region_size * region;
+	memcpy(mapped + offset, data, size);
+	return offset;
+}
+
+void StreamBuffer::fence()
+{
+	if (!persistent)
+		return;
+	assert(!fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	gl_has_errors();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <array>
+
+// Regions the ring cycles through, the GPU may still be reading the two written before the current one
+const uint STREAM_BUFFER_REGIONS = 3;
+
+// Vertex buffer rewritten every frame. Where the driver has buffer storage it is mapped once and
+// written in place, one region per frame, with a fence making sure the GPU is done with a region
+// before it is reused. Otherwise every upload orphans the storage and writes through glBufferSubData.
+class StreamBuffer
+{
+public:
+	// Region size in bytes, keep it a multiple of the vertex size so region starts are whole vertices
+	void init(GLsizeiptr region_size);
+	void destroy();
+
+	// Copies the data into the next region and returns its byte offset in the buffer. Anything past
+	// the region size is dropped. Call at most once per frame, after the previous frame's fence()
+	GLintptr upload(const void *data, GLsizeiptr size);
+	// Call after the draws reading the last upload have been issued
+	void fence();
+
+	GLuint buffer = 0;
+	bool persistent = false;
+
+private:
+	GLsizeiptr region_size = 0;
+	uint region = 0;
+	unsigned char *mapped = nullptr;
+	std::array<GLsync, STREAM_BUFFER_REGIONS> fences = {};
+};
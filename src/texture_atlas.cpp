@@ -0,0 +1,46 @@
+// internal
+#include "texture_atlas.hpp"
+
+// stlib
+#include <algorithm>
+#include <numeric>
+
+bool fits_in_atlas(ivec2 size)
+{
+	return size.x <= ATLAS_MAX_SPRITE_SIDE && size.y <= ATLAS_MAX_SPRITE_SIDE && size.x * size.y <= ATLAS_MAX_SPRITE_AREA;
+}
+
+int pack_atlas(const std::vector<ivec2>& sizes, std::vector<AtlasRect>& rects)
+{
+	rects.assign(sizes.size(), { -1, { 0, 0 } });
+	if (sizes.empty())
+		return 0;
+
+	std::vector<uint> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint a, uint b) {
+		return sizes[a].y != sizes[b].y ? sizes[a].y > sizes[b].y : sizes[a].x > sizes[b].x;
+	});
+
+	int page = 0;
+	ivec2 cursor = { 0, 0 };
+	int shelf_height = 0;
+	for (uint i: order) {
+		ivec2 padded = sizes[i] + 2 * ATLAS_PADDING;
+		assert(padded.x <= ATLAS_PAGE_SIZE && padded.y <= ATLAS_PAGE_SIZE);
+		if (cursor.x + padded.x > ATLAS_PAGE_SIZE) {
+			// start a new shelf under the current one
+			cursor = { 0, cursor.y + shelf_height };
+			shelf_height = 0;
+		}
+		if (cursor.y + padded.y > ATLAS_PAGE_SIZE) {
+			page++;
+			cursor = { 0, 0 };
+			shelf_height = 0;
+		}
+		rects[i] = { page, cursor + ATLAS_PADDING };
+		cursor.x += padded.x;
+		shelf_height = max(shelf_height, padded.y);
+	}
+	return page + 1;
+}
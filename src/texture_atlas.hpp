@@ -0,0 +1,29 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <vector>
+
+// Atlas pages are square, 2048 is supported everywhere we run
+const int ATLAS_PAGE_SIZE = 2048;
+// Sprites bigger than this on either side, or in area, keep their own texture
+// (backgrounds, dialogue screens, the boss sprite sheet)
+const int ATLAS_MAX_SPRITE_SIDE = 1024;
+const int ATLAS_MAX_SPRITE_AREA = 512 * 512;
+// Transparent gap around each sprite so sampling at a sprite's edge never picks up its neighbour
+const int ATLAS_PADDING = 2;
+
+struct AtlasRect
+{
+	int page;
+	// top left corner of the sprite in the page, in pixels, padding excluded
+	ivec2 position;
+};
+
+bool fits_in_atlas(ivec2 size);
+
+// Shelf packs the sizes, tallest first, into as few pages as it can. rects follows the order of sizes.
+// Returns the number of pages used
+int pack_atlas(const std::vector<ivec2>& sizes, std::vector<AtlasRect>& rects);
@@ -19,7 +19,7 @@ public:
 	ComponentContainer<Gravity> gravities;
 	ComponentContainer<TestAI> testAIs;
 	ComponentContainer<Collision> collisions;
-	ComponentContainer<ParallaxBackground> parallaxBackgrounds;
+	ComponentContainer<Lava> lavas;
 	ComponentContainer<Player> players;
     ComponentContainer<Boss> boss;
 	ComponentContainer<BossSword> bossSwords;
@@ -28,6 +28,7 @@ public:
 	ComponentContainer<Mesh *> meshPtrs;
 	ComponentContainer<CollisionMesh *> collisionMeshPtrs;
 	ComponentContainer<RenderRequest> renderRequests;
+	ComponentContainer<Text> texts;
     ComponentContainer<Blank> debugRenderRequests;
 	ComponentContainer<ScreenState> screenStates;
 	ComponentContainer<SpitterEnemy> spitterEnemies;
@@ -73,7 +74,7 @@ public:
 		registry_list.push_back(&projectiles);
 		registry_list.push_back(&gravities);
 		registry_list.push_back(&testAIs);
-		registry_list.push_back(&parallaxBackgrounds);
+		registry_list.push_back(&lavas);
 		registry_list.push_back(&collisions);
 		registry_list.push_back(&players);
         registry_list.push_back(&boss);
@@ -83,6 +84,7 @@ public:
 		registry_list.push_back(&meshPtrs);
 		registry_list.push_back(&collisionMeshPtrs);
 		registry_list.push_back(&renderRequests);
+		registry_list.push_back(&texts);
         registry_list.push_back(&debugRenderRequests);
 		registry_list.push_back(&screenStates);
 		registry_list.push_back(&spitterEnemies);
@@ -67,10 +67,7 @@ void collect_weapon(Entity weapon, Entity hero) {
 			registry.remove_all_components_of(weapon);
 		} else {
 			if (registry.players.get(hero).hasWeapon) {
-				if (registry.grenadeLaunchers.has(registry.players.get(hero).weapon)) {
-					for(Entity line: registry.grenadeLaunchers.get(registry.players.get(hero).weapon).trajectory)
-						registry.remove_all_components_of(line);
-				} else if (registry.tridents.has(weapon)) {
+				if (registry.tridents.has(weapon)) {
 					for (WaterBall& water_ball: registry.waterBalls.components)
 						water_ball.drawing = false;
 				}
@@ -164,36 +161,49 @@ void rotate_weapon(Entity weapon, vec2 mouse_pos) {
 	}
 }
 
-std::vector<Entity> create_grenade_trajectory(RenderSystem* renderer, vec2 launch_start, vec2 velocity) {
-	std::vector<Entity> lines;
-	vec2 start_point = launch_start;
+// Points along the arc, relative to launch_start
+std::vector<vec2> create_grenade_trajectory(vec2 launch_start, vec2 velocity) {
+	std::vector<vec2> points = { {0, 0} };
 	vec2 end_point = launch_start;
 	float velocity_change = GRAVITY_ACCELERATION_FACTOR * GRENADE_TRAJECTORY_SEGMENT_TIME;
 	float segment_seconds = GRENADE_TRAJECTORY_SEGMENT_TIME / 1000.f;
 	while(end_point.y - launch_start.y < 1.5 * window_height_px) {
-		start_point = end_point;
 		velocity.y += velocity_change;
-		end_point = start_point + velocity * segment_seconds;
-		vec2 line_position = launch_start;
-		vec2 line_offset = (start_point + end_point) / 2.f - launch_start;
-		vec2 line_scale = {sqrt(dot(end_point - start_point, end_point - start_point)), TRAJECTORY_WIDTH};
-		float line_angle = atan2(end_point.y - start_point.y, end_point.x - start_point.x);
-		lines.push_back(createLine(renderer, line_position, line_offset, line_scale, line_angle));
+		end_point += velocity * segment_seconds;
+		points.push_back(end_point - launch_start);
+	}
+	return points;
+}
+
+void stream_trajectories(RenderSystem* renderer) {
+	static std::vector<vec2> points;
+	for (GrenadeLauncher& launcher: registry.grenadeLaunchers.components) {
+		points.clear();
+		for (vec2 point: launcher.trajectory)
+			points.push_back(launcher.trajectory_origin + point);
+		renderer->streamPolyline(points, TRAJECTORY_WIDTH, TEXTURE_ASSET_ID::LINE);
+	}
+	for (WaterBall& water_ball: registry.waterBalls.components) {
+		if (!water_ball.show_trajectory)
+			continue;
+		// the odd points are the bezier control points between two mouse positions
+		points.clear();
+		for (size_t i = 0; i < water_ball.points.size(); i += 2)
+			points.push_back(water_ball.points[i]);
+		renderer->streamPolyline(points, TRAJECTORY_WIDTH, TEXTURE_ASSET_ID::LINE);
 	}
-	return lines;
 }
 
 void update_weapon_angle(RenderSystem* renderer, Entity weapon, vec2 mouse_pos, bool mouse_clicked) {
 	mouse_cur_pos = mouse_pos;
 	if (mouse_click_pos != vec2(-1.f, -1.f) && drag_delay <= 0) {
 		rotate_weapon(weapon, registry.motions.get(weapon).position + mouse_click_pos - mouse_cur_pos);
-		for (Entity line: registry.grenadeLaunchers.get(weapon).trajectory) {
-			registry.remove_all_components_of(line);
-		}
 		Motion& motion = registry.motions.get(weapon);
 		float angle = motion.angle;
 		mat2 rot_mat = {{cos(angle), -sin(angle)}, {sin(angle), cos(angle)}};
-		registry.grenadeLaunchers.get(weapon).trajectory = create_grenade_trajectory(renderer, motion.position + vec2(motion.positionOffset.x + abs(motion.scale.x) / 2.f, 0) * rot_mat, (mouse_click_pos - mouse_cur_pos) * GRENADE_SPEED_FACTOR);
+		GrenadeLauncher& launcher = registry.grenadeLaunchers.get(weapon);
+		launcher.trajectory_origin = motion.position + vec2(motion.positionOffset.x + abs(motion.scale.x) / 2.f, 0) * rot_mat;
+		launcher.trajectory = create_grenade_trajectory(launcher.trajectory_origin, (mouse_click_pos - mouse_cur_pos) * GRENADE_SPEED_FACTOR);
 	} else if (registry.weapons.get(weapon).type == COLLECTABLE_TYPE::TRIDENT && mouse_clicked) {
 		for (Entity entity: registry.waterBalls.entities) {
 			WaterBall& water_ball = registry.waterBalls.get(entity);
@@ -205,8 +215,6 @@ void update_weapon_angle(RenderSystem* renderer, Entity weapon, vec2 mouse_pos,
 				vec2 betweener = (last + mouse_pos) / 2.f;
 				water_ball.points.push_back(betweener);
 				water_ball.points.push_back(mouse_pos);
-				float angle = atan2(mouse_pos.y - water_ball.points[water_ball.points.size() - 3].y, mouse_pos.x - water_ball.points[water_ball.points.size() - 3].x);
-				water_ball.trajectory.push_back(createLine(renderer, betweener, {0, 0}, {dist, TRAJECTORY_WIDTH}, angle));
 			}
 		}
 		rotate_weapon(weapon, mouse_pos);
@@ -326,10 +334,10 @@ void update_water_balls(float elapsed_ms, COLLECTABLE_TYPE weapon_type, bool mou
 			animation.curState = 1;
 			hit_box.isActive = true;
 			play_sound(SOUND_EFFECT::WATER_BALL_SHOOT);
-			for (Entity line: water_ball.trajectory)
-				registry.remove_all_components_of(line);
+			water_ball.show_trajectory = false;
 
-			if (water_ball.trajectory.size() > 1) {
+			// more than one segment was drawn
+			if (water_ball.points.size() > 3) {
 				water_ball.state++;
 			} else {
 				motion.velocity = vec2(WATER_BALL_SPEED, 0) * mat2({cos(motion.angleBackup), -sin(motion.angleBackup)}, {sin(motion.angleBackup), cos(motion.angleBackup)});
@@ -377,8 +385,6 @@ void weapon_mouse_release() {
 			vec2 start = water_ball.points[0];
 			water_ball.points.clear();
 			water_ball.points.push_back(start);
-			for (Entity line: water_ball.trajectory)
-				registry.remove_all_components_of(line);
 		}
 		water_ball.drawing = false;
 	}
@@ -441,17 +447,13 @@ void update_weapon(RenderSystem* renderer, float elapsed_ms, Entity hero, bool m
 				velocity = vec2(500.f, 0) * rot_mat;
 			createGrenade(renderer, position, velocity);
 			play_sound(SOUND_EFFECT::GRENADE_LAUNCHER_FIRE);
-			for (Entity line: launcher.trajectory)
-				registry.remove_all_components_of(line);
 			launcher.trajectory.clear();
 			launcher.cooldown = GRENADE_COOLDOWN;
 			launcher.loaded = false;
 			mouse_click_pos = {-1.f, -1.f};
 		} else if (mouse_click_pos != vec2({-1.f, -1.f}) && !launcher.trajectory.empty()) {
-			for (Entity line: launcher.trajectory) {
-				float angle = weaponMot.angle;
-				registry.motions.get(line).position = weaponMot.position + vec2(weaponMot.positionOffset.x + abs(weaponMot.scale.x) / 2.f, 0) * mat2({cos(angle), -sin(angle)}, {sin(angle), cos(angle)});
-			}
+			float angle = weaponMot.angle;
+			launcher.trajectory_origin = weaponMot.position + vec2(weaponMot.positionOffset.x + abs(weaponMot.scale.x) / 2.f, 0) * mat2({cos(angle), -sin(angle)}, {sin(angle), cos(angle)});
 		} 
 	} else if (registry.tridents.has(weapon)) {
 		Trident& trident = registry.tridents.get(weapon);
@@ -10,6 +10,8 @@
 
 void initiate_weapons();
 void collect(Entity weapon, Entity hero);
+// Hands the grenade and water ball paths to the renderer's per frame geometry
+void stream_trajectories(RenderSystem* renderer);
 void update_weapon_angle(RenderSystem* renderer, Entity weapon, vec2 mouse_pos, bool mouse_clicked);
 void update_equipment(float elapsed_ms, Entity hero);
 void update_grenades(RenderSystem* renderer, float elapsed_ms);
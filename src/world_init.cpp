@@ -27,7 +27,7 @@ Entity createHero(RenderSystem *renderer, vec2 pos)
 		{TEXTURE_ASSET_ID::HERO,
 		 EFFECT_ASSET_ID::HERO,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          SPRITE_SCALE.at(TEXTURE_ASSET_ID::HERO),
          SPRITE_OFFSET.at(TEXTURE_ASSET_ID::HERO)});
@@ -61,7 +61,7 @@ Entity createBoulder(RenderSystem* renderer, vec2 position, vec2 velocity, float
 		{ TEXTURE_ASSET_ID::BOULDER,
 			EFFECT_ASSET_ID::TEXTURED,
 			GEOMETRY_BUFFER_ID::SPRITE,
-			false,
+			RENDER_LAYER::WORLD,
 			true,
 			motion.scale});
 
@@ -100,7 +100,7 @@ Entity createFireing(RenderSystem *renderer, vec2 position)
 		{TEXTURE_ASSET_ID::FIRE_ENEMY,
 		 EFFECT_ASSET_ID::FIRE_ENEMY,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
 		 SPRITE_SCALE.at(TEXTURE_ASSET_ID::FIRE_ENEMY),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::FIRE_ENEMY) });
@@ -143,7 +143,7 @@ Entity createBossEnemy(RenderSystem *renderer, vec2 position)
             {TEXTURE_ASSET_ID::BOSS,
              EFFECT_ASSET_ID::BOSS,
              GEOMETRY_BUFFER_ID::SPRITE,
-             false,
+             RENDER_LAYER::WORLD,
              true,
              SPRITE_SCALE.at(TEXTURE_ASSET_ID::BOSS),
              SPRITE_OFFSET.at(TEXTURE_ASSET_ID::BOSS) });
@@ -204,7 +204,7 @@ Entity create_boss_sword(RenderSystem* renderer, vec2 position, int type) {
 			{ TEXTURE_ASSET_ID::BOSS_SWORD_S,
 			 EFFECT_ASSET_ID::BOSS_SWORD_S,
 			 GEOMETRY_BUFFER_ID::SPRITE,
-			 false,
+			 RENDER_LAYER::WORLD,
 			 true,
 			 SPRITE_SCALE.at(TEXTURE_ASSET_ID::BOSS_SWORD_S),
 			 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::BOSS_SWORD_S) });
@@ -217,7 +217,7 @@ Entity create_boss_sword(RenderSystem* renderer, vec2 position, int type) {
 			{ TEXTURE_ASSET_ID::BOSS_SWORD_L,
 			 EFFECT_ASSET_ID::BOSS_SWORD_L,
 			 GEOMETRY_BUFFER_ID::SPRITE,
-			 false,
+			 RENDER_LAYER::WORLD,
 			 true,
 			 SPRITE_SCALE.at(TEXTURE_ASSET_ID::BOSS_SWORD_L),
 			 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::BOSS_SWORD_L) });
@@ -260,7 +260,7 @@ Entity createGhoul(RenderSystem* renderer, vec2 position)
 		{ TEXTURE_ASSET_ID::GHOUL_ENEMY,
 		 EFFECT_ASSET_ID::GHOUL,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 SPRITE_SCALE.at(TEXTURE_ASSET_ID::GHOUL_ENEMY),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::GHOUL_ENEMY) });
@@ -295,7 +295,7 @@ Entity createFollowingEnemy(RenderSystem* renderer, vec2 position)
 		{ TEXTURE_ASSET_ID::FOLLOWING_ENEMY,
 		 EFFECT_ASSET_ID::FOLLOWING_ENEMY,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 SPRITE_SCALE.at(TEXTURE_ASSET_ID::FOLLOWING_ENEMY),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::FOLLOWING_ENEMY) });
@@ -339,7 +339,7 @@ Entity createSpitterEnemy(RenderSystem *renderer, vec2 pos)
 		{TEXTURE_ASSET_ID::SPITTER_ENEMY,
 		 EFFECT_ASSET_ID::SPITTER_ENEMY,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          SPRITE_SCALE.at(TEXTURE_ASSET_ID::SPITTER_ENEMY),
          SPRITE_OFFSET.at(TEXTURE_ASSET_ID::SPITTER_ENEMY)});
@@ -378,7 +378,7 @@ Entity createSpitterEnemyBullet(RenderSystem *renderer, vec2 pos, float angle)
 		{TEXTURE_ASSET_ID::SPITTER_ENEMY_BULLET,
 		 EFFECT_ASSET_ID::SPITTER_ENEMY_BULLET,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -399,84 +399,37 @@ Entity createMainMenuBackground(RenderSystem *renderer) {
             {TEXTURE_ASSET_ID::TITLE_SCREEN_BG,
              EFFECT_ASSET_ID::TEXTURED,
              GEOMETRY_BUFFER_ID::SPRITE,
-             false,
+             RENDER_LAYER::BACKGROUND,
              true,
              motion.scale});
 
     return entity;
 }
 
-Entity createParallaxItem(RenderSystem *renderer, vec2 pos, TEXTURE_ASSET_ID texture_id)
+Entity createLava(RenderSystem *renderer, vec2 pos)
 {
 	Entity entity = Entity();
-	vec2 vel;
-	if (texture_id == TEXTURE_ASSET_ID::BACKGROUND || texture_id == TEXTURE_ASSET_ID::BACKGROUND_COLOR || texture_id == TEXTURE_ASSET_ID::PARALLAX_MOON)
-	{
-		vel = vec2();
-	}
-	else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE)
-	{
-		// moves to the right
-		vel = vec2(10, 0);
-	}
-	else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR)
-	{
-		// moves to the right slowly
-		vel = vec2(5, 0);
-	}
-	else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_RAIN)
-	{
-		vel = vec2(40, 120);
-	} else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA) 
-	{
-		vel = vec2(10, 0);
-		CollisionMesh &mesh = renderer->getCollisionMesh(GEOMETRY_BUFFER_ID::SPRITE);
-		registry.collisionMeshPtrs.emplace(entity, &mesh);
-	}
-	vel *= 5;
+	CollisionMesh &mesh = renderer->getCollisionMesh(GEOMETRY_BUFFER_ID::SPRITE);
+	registry.collisionMeshPtrs.emplace(entity, &mesh);
 
 	auto &motion = registry.motions.emplace(entity);
-
 	motion.angle = 0.f;
-	motion.velocity = vel;
+	motion.velocity = { 0.f, 0.f };
 	motion.position = pos;
-	if (texture_id == TEXTURE_ASSET_ID::BACKGROUND ||
-		texture_id == TEXTURE_ASSET_ID::BACKGROUND_COLOR ||
-		texture_id == TEXTURE_ASSET_ID::PARALLAX_MOON ||
-		texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE ||
-		texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR)
-	{
-		motion.scale = {pos.x * 2, pos.y * 2};
-	}
-	else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA) {
-		motion.scale = ASSET_SIZE.at(TEXTURE_ASSET_ID::PARALLAX_LAVA);
-	}
-	else
-	{
-		motion.scale = {1200, 800};
-	}
+	motion.scale = ASSET_SIZE.at(TEXTURE_ASSET_ID::PARALLAX_LAVA);
 
-	ParallaxBackground &bg = registry.parallaxBackgrounds.emplace(entity);
-	if (texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE || texture_id == TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR) {
-		bg.resetPosition = vec2(-800, 400);
-	} else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_RAIN) {
-		bg.resetPosition = vec2(400, 0);
-	} else if (texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA) {
-		bg.resetPosition = vec2(-600, 813);
-	}
+	registry.lavas.emplace(entity);
 
-	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
+	// never drawn itself, the request is there for the debug hitbox
 	registry.renderRequests.insert(
 		entity,
-		{texture_id,
+		{TEXTURE_ASSET_ID::PARALLAX_LAVA,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
+		 RENDER_LAYER::BACKGROUND,
 		 false,
-		 true,
-		 texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA ? SPRITE_SCALE.at(TEXTURE_ASSET_ID::PARALLAX_LAVA) : motion.scale,
-		 texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA ? SPRITE_OFFSET.at(TEXTURE_ASSET_ID::PARALLAX_LAVA) : vec2({0, 0})});
-	if (texture_id == TEXTURE_ASSET_ID::PARALLAX_LAVA)
-		registry.debugRenderRequests.emplace(entity);
+		 motion.scale});
+	registry.debugRenderRequests.emplace(entity);
 	return entity;
 }
 
@@ -497,9 +450,10 @@ Entity createHelperText(RenderSystem* renderer, float size)
             {TEXTURE_ASSET_ID::HELPER,
              EFFECT_ASSET_ID::TEXTURED,
              GEOMETRY_BUFFER_ID::SPRITE,
-             true,
+             RENDER_LAYER::OVERLAY,
              false,
              motion.scale});
+    registry.renderRequests.get(entity).depth = HELPER_DEPTH;
     registry.showWhenPaused.emplace(entity);
     return entity;
 }
@@ -516,7 +470,7 @@ Entity createToolTip(RenderSystem* renderer, vec2 pos, TEXTURE_ASSET_ID type) {
             {type,
              EFFECT_ASSET_ID::TEXTURED,
              GEOMETRY_BUFFER_ID::SPRITE,
-             true,
+             RENDER_LAYER::OVERLAY,
              true,
             motion.scale});
 
@@ -549,9 +503,10 @@ Entity createSword(RenderSystem *renderer, vec2 position)
 		{TEXTURE_ASSET_ID::SWORD,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          motion.scale});
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
 	registry.debugRenderRequests.emplace(entity);
 
 	return entity;
@@ -583,10 +538,11 @@ Entity createGun(RenderSystem *renderer, vec2 position)
 		{TEXTURE_ASSET_ID::GUN,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          SPRITE_SCALE.at(TEXTURE_ASSET_ID::GUN),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::GUN)});
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
     registry.debugRenderRequests.emplace(entity);
 
 	return entity;
@@ -616,7 +572,7 @@ Entity createArrow(RenderSystem* renderer, vec2 position, float angle) {
 		{ TEXTURE_ASSET_ID::ARROW,
 			EFFECT_ASSET_ID::TEXTURED,
 			GEOMETRY_BUFFER_ID::SPRITE,
-          false,
+          RENDER_LAYER::WORLD,
           true,
           motion.scale});
 
@@ -649,9 +605,10 @@ Entity createRocketLauncher(RenderSystem *renderer, vec2 position)
 		{TEXTURE_ASSET_ID::ROCKET_LAUNCHER,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale});
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
     registry.debugRenderRequests.emplace(entity);
 
 	return entity;
@@ -678,7 +635,7 @@ Entity createRocket(RenderSystem* renderer, vec2 position, float angle) {
 		{ TEXTURE_ASSET_ID::ROCKET,
 			EFFECT_ASSET_ID::TEXTURED,
 			GEOMETRY_BUFFER_ID::SPRITE,
-			false,
+			RENDER_LAYER::WORLD,
 			true,
 			motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -713,10 +670,11 @@ Entity createGrenadeLauncher(RenderSystem *renderer, vec2 position)
 		{TEXTURE_ASSET_ID::GRENADE_LAUNCHER,
 		 EFFECT_ASSET_ID::GRENADE_ORB,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 SPRITE_SCALE.at(TEXTURE_ASSET_ID::GRENADE_LAUNCHER),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::GRENADE_LAUNCHER)});
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
     registry.debugRenderRequests.emplace(entity);
 
 	return entity;
@@ -748,7 +706,7 @@ Entity createGrenade(RenderSystem* renderer, vec2 position, vec2 velocity) {
 		{ TEXTURE_ASSET_ID::GRENADE,
 			EFFECT_ASSET_ID::GRENADE_ORB,
 			GEOMETRY_BUFFER_ID::SPRITE,
-			false,
+			RENDER_LAYER::WORLD,
 			true,
 		SPRITE_SCALE.at(TEXTURE_ASSET_ID::GRENADE),
 		SPRITE_OFFSET.at(TEXTURE_ASSET_ID::GRENADE)});
@@ -783,7 +741,7 @@ Entity createExplosion(RenderSystem *renderer, vec2 position, float size)
 		{TEXTURE_ASSET_ID::EXPLOSION,
 		 EFFECT_ASSET_ID::EXPLOSION,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 size * SPRITE_SCALE.at(TEXTURE_ASSET_ID::EXPLOSION),
 		 size * SPRITE_OFFSET.at(TEXTURE_ASSET_ID::EXPLOSION)});
@@ -815,9 +773,10 @@ Entity createLaserRifle(RenderSystem* renderer, vec2 position)
 		{ TEXTURE_ASSET_ID::LASER_RIFLE,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
 	registry.debugRenderRequests.emplace(entity);
 	return entity;
 }
@@ -843,7 +802,7 @@ Entity createLaser(RenderSystem* renderer, vec2 position, float angle) {
 		{ TEXTURE_ASSET_ID::LASER,
 			EFFECT_ASSET_ID::TEXTURED,
 			GEOMETRY_BUFFER_ID::SPRITE,
-			false,
+			RENDER_LAYER::WORLD,
 			true,
 			motion.scale });
 	registry.debugRenderRequests.emplace(entity);
@@ -873,9 +832,10 @@ Entity createTrident(RenderSystem* renderer, vec2 position)
 		{ TEXTURE_ASSET_ID::TRIDENT,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = WEAPON_DEPTH;
 	registry.debugRenderRequests.emplace(entity);
 	return entity;
 }
@@ -904,7 +864,7 @@ Entity createWaterBall(RenderSystem* renderer, vec2 position, float angle) {
 		{ TEXTURE_ASSET_ID::WATER_BALL,
 			EFFECT_ASSET_ID::WATER_BALL,
 			GEOMETRY_BUFFER_ID::SPRITE,
-			false,
+			RENDER_LAYER::WORLD,
 			true,
 			SPRITE_SCALE.at(TEXTURE_ASSET_ID::WATER_BALL),
 			SPRITE_OFFSET.at(TEXTURE_ASSET_ID::WATER_BALL)});
@@ -932,7 +892,7 @@ Entity createHeart(RenderSystem* renderer, vec2 position) {
 		{TEXTURE_ASSET_ID::HEART,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -960,7 +920,7 @@ Entity createPickaxe(RenderSystem* renderer, vec2 position) {
 		{TEXTURE_ASSET_ID::PICKAXE,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -988,7 +948,7 @@ Entity createWingedBoots(RenderSystem* renderer, vec2 position) {
 		{TEXTURE_ASSET_ID::WINGED_BOOTS,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -1016,7 +976,7 @@ Entity createDashBoots(RenderSystem* renderer, vec2 position) {
 		{TEXTURE_ASSET_ID::DASH_BOOTS,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -1042,7 +1002,7 @@ Entity createBlock(RenderSystem* renderer, vec2 pos, vec2 size)
 		{TEXTURE_ASSET_ID::TEXTURE_COUNT, // TEXTURE_COUNT indicates that no txture is needed
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          false,
          motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -1064,7 +1024,7 @@ Entity createWeaponHitBox(RenderSystem* renderer, vec2 pos, vec2 size, WeaponHit
 		{TEXTURE_ASSET_ID::TEXTURE_COUNT, // TEXTURE_COUNT indicates that no txture is needed
 		 EFFECT_ASSET_ID::COLOURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          motion.scale});
     registry.debugRenderRequests.emplace(entity);
@@ -1088,7 +1048,7 @@ Entity createButton(RenderSystem* renderer, vec2 pos, TEXTURE_ASSET_ID type, std
             {type,
              EFFECT_ASSET_ID::TEXTURED,
              GEOMETRY_BUFFER_ID::SPRITE,
-             true,
+             RENDER_LAYER::OVERLAY,
              visibility,
             motion.scale});
     if (!visibility) {
@@ -1113,7 +1073,7 @@ Entity createTitleText(RenderSystem* renderer, vec2 pos) {
 		{TEXTURE_ASSET_ID::TITLE_TEXT,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-         false,
+         RENDER_LAYER::WORLD,
          true,
          motion.scale});
 	registry.showWhenPaused.emplace(entity);
@@ -1134,7 +1094,7 @@ Entity createPlayerHeart(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::PLAYER_HEART,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 false,
 		 motion.scale });
 
@@ -1143,27 +1103,6 @@ Entity createPlayerHeart(RenderSystem* renderer, vec2 pos) {
 	return entity;
 }
 
-Entity createLine(RenderSystem* renderer, vec2 pos, vec2 offset, vec2 scale, float angle) {
-	Entity entity = Entity();
-
-	Motion& motion = registry.motions.emplace(entity);
-	motion.position = pos;
-	motion.positionOffset = offset;
-	motion.scale = scale;
-	motion.globalAngle = angle;
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::LINE,
-		 EFFECT_ASSET_ID::TEXTURED,
-		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
-		 true,
-		 motion.scale });
-
-	return entity;
-}
-
 Entity createPowerUpIcon(RenderSystem* renderer, vec2 pos) {
 	Entity entity = Entity();
 
@@ -1178,7 +1117,7 @@ Entity createPowerUpIcon(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::TEXTURE_COUNT,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 false,
 		 motion.scale });
 
@@ -1201,7 +1140,7 @@ Entity createDifficultyBar(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::DIFFICULTY_BAR,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 true,
 		 motion.scale });
 
@@ -1224,9 +1163,10 @@ Entity createDifficultyIndicator(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::INDICATOR,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = DIFFICULTY_MARKER_DEPTH;
 
 	registry.inGameGUIs.emplace(entity);
 
@@ -1247,7 +1187,7 @@ Entity createScore(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::SCORE,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 false,
 		 motion.scale });
 
@@ -1257,28 +1197,41 @@ Entity createScore(RenderSystem* renderer, vec2 pos) {
 }
 
 Entity createNumber(RenderSystem* renderer, vec2 pos) {
+	// five digits, hidden until the score is shown
+	Text text;
+	text.string = "00000";
+	text.size = NUMBER_HEIGHT;
+	text.spacing = NUMBER_GAP - NUMBER_HEIGHT * renderer->glyph('0').aspect;
+	text.align = TEXT_ALIGN::CENTER;
+	text.visibility = false;
+	Entity entity = createText(renderer, pos, text);
+
+	registry.inGameGUIs.emplace(entity);
+
+	return entity;
+}
+
+Entity createText(RenderSystem* renderer, vec2 pos, const Text& text) {
 	Entity entity = Entity();
 
 	auto& motion = registry.motions.emplace(entity);
 	motion.angle = 0.f;
 	motion.velocity = { 0.f, 0.f };
-	motion.scale = { 20.f, 29.f };
 	motion.position = pos;
 
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::ZERO,
-		 EFFECT_ASSET_ID::TEXTURED,
-		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
-		 false,
-		 motion.scale });
-
-	registry.inGameGUIs.emplace(entity);
+	registry.texts.insert(entity, text);
 
 	return entity;
 }
 
+Entity createText(RenderSystem* renderer, vec2 pos, const std::string& string, float size, TEXT_ALIGN align) {
+	Text text;
+	text.string = string;
+	text.size = size;
+	text.align = align;
+	return createText(renderer, pos, text);
+}
+
 Entity createDBFlame(RenderSystem* renderer, vec2 pos) {
 	Entity entity = Entity();
 
@@ -1293,9 +1246,10 @@ Entity createDBFlame(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::DB_BOSS_FLAME,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = DIFFICULTY_MARKER_DEPTH;
 
 	registry.inGameGUIs.emplace(entity);
 
@@ -1316,9 +1270,10 @@ Entity createDBSkull(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::DB_BOSS_SKULL,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = DIFFICULTY_MARKER_DEPTH;
 
 	registry.inGameGUIs.emplace(entity);
 
@@ -1339,9 +1294,10 @@ Entity createDBSatan(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::DB_SATAN,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 true,
+		 RENDER_LAYER::OVERLAY,
 		 true,
 		 motion.scale });
+	registry.renderRequests.get(entity).depth = DIFFICULTY_MARKER_DEPTH;
 
 	registry.inGameGUIs.emplace(entity);
 
@@ -1367,7 +1323,7 @@ Entity createLavaPillar(RenderSystem* renderer, vec2 pos) {
 		{ TEXTURE_ASSET_ID::LAVA_PILLAR, // TEXTURE_COUNT indicates that no txture is needed
 		 EFFECT_ASSET_ID::LAVA_PILLAR,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::WORLD,
 		 true,
 		 SPRITE_SCALE.at(TEXTURE_ASSET_ID::LAVA_PILLAR),
 		 SPRITE_OFFSET.at(TEXTURE_ASSET_ID::LAVA_PILLAR) });
@@ -1388,7 +1344,7 @@ Entity createHealthBar(RenderSystem* renderer, Entity owner) {
             { TEXTURE_ASSET_ID::HEALTH_BAR_HEALTH,
               EFFECT_ASSET_ID::HEALTH_BAR,
               GEOMETRY_BUFFER_ID::SPRITE,
-              false,
+              RENDER_LAYER::WORLD,
               true,
               motion.scale});
 
@@ -1401,9 +1357,11 @@ Entity createHealthBar(RenderSystem* renderer, Entity owner) {
             { TEXTURE_ASSET_ID::HEALTH_BAR,
               EFFECT_ASSET_ID::TEXTURED,
               GEOMETRY_BUFFER_ID::SPRITE,
-              false,
+              RENDER_LAYER::WORLD,
               true,
               motion2.scale });
+    // frame over the fill
+    registry.renderRequests.get(bar).depth = 1;
 
     healthBar.bar = bar;
     healthBar.owner = owner;
@@ -1425,9 +1383,11 @@ Entity createDialogue(RenderSystem* renderer, TEXTURE_ASSET_ID texture_id) {
 		{ TEXTURE_ASSET_ID::CONTINUE_HELPER,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::DIALOGUE,
 		 true,
 		 text_motion.scale });
+	// continue prompt over the portrait
+	registry.renderRequests.get(text).depth = 1;
 
 	registry.dialogueTexts.emplace(text);
 
@@ -1446,7 +1406,7 @@ Entity createDialogue(RenderSystem* renderer, TEXTURE_ASSET_ID texture_id) {
 		{ texture_id,
 		 EFFECT_ASSET_ID::TEXTURED,
 		 GEOMETRY_BUFFER_ID::SPRITE,
-		 false,
+		 RENDER_LAYER::DIALOGUE,
 		 true,
 		 motion.scale });
 
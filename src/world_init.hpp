@@ -36,6 +36,11 @@ const vec2 LAVA_PILLAR_BB = vec2(120, 536);
 const vec2 TRIDENT_BB = vec2(16, 32) * 1.5f;
 const vec2 MAIN_MENU_BG_BB = vec2(1200, 800);
 
+// Depths within a render layer (RenderRequest::depth), anything not listed is at 0
+const int WEAPON_DEPTH = 1; // held weapons over the hero
+const int DIFFICULTY_MARKER_DEPTH = 1; // indicator and boss markers over the difficulty bar
+const int HELPER_DEPTH = 2; // the pause help covers the rest of the interface
+
 const int SWORD_DMG = 7;
 const int EXPLOSIVE_DMG = 6;
 const int DIR_EXPLOSIVE_DMG = 12;
@@ -145,7 +150,6 @@ const std::map<TEXTURE_ASSET_ID, vec2 > SPRITE_SCALE = {
         { TEXTURE_ASSET_ID::BOSS_SWORD_S, {19, 21}},
         { TEXTURE_ASSET_ID::BOSS_SWORD_L, {19, 21}},
         { TEXTURE_ASSET_ID::EXPLOSION, {100, 92}},
-        { TEXTURE_ASSET_ID::PARALLAX_LAVA, {1200, 800}},
         { TEXTURE_ASSET_ID::LAVA_PILLAR, LAVA_PILLAR_BB},
         { TEXTURE_ASSET_ID::WATER_BALL, {64, 64}},
         { TEXTURE_ASSET_ID::GRENADE_LAUNCHER, GRENADE_LAUNCHER_BB},
@@ -163,7 +167,6 @@ const std::map<TEXTURE_ASSET_ID, vec2 > SPRITE_OFFSET = {
         { TEXTURE_ASSET_ID::BOSS_SWORD_S, {0, 0}},
         { TEXTURE_ASSET_ID::BOSS_SWORD_L, {0, 0}},
         { TEXTURE_ASSET_ID::EXPLOSION, {0, -8}},
-        { TEXTURE_ASSET_ID::PARALLAX_LAVA, {0, -378}},
         { TEXTURE_ASSET_ID::LAVA_PILLAR, {0,-80}},
         { TEXTURE_ASSET_ID::WATER_BALL, {-17,0}},
         { TEXTURE_ASSET_ID::GRENADE_LAUNCHER, {4 * CHARACTER_SCALING, -2 * CHARACTER_SCALING}},
@@ -309,7 +312,8 @@ Entity createPickaxe(RenderSystem* renderer, vec2 position);
 Entity createMainMenuBackground(RenderSystem* renderer);
 
 // the parallax backgrounds
-Entity createParallaxItem(RenderSystem* renderer, vec2 pos, TEXTURE_ASSET_ID texture_id);
+// the lava's collider, the lava itself is a layer of the parallax background
+Entity createLava(RenderSystem* renderer, vec2 pos);
 // the helper text during pause
 Entity createHelperText(RenderSystem* renderer, float size);
 Entity createToolTip(RenderSystem* renderer, vec2 pos, TEXTURE_ASSET_ID type);
@@ -319,13 +323,15 @@ Entity createButton(RenderSystem* renderer, vec2 pos, TEXTURE_ASSET_ID type, std
 Entity createWeaponHitBox(RenderSystem* renderer, vec2 pos, vec2 size, WeaponHitBox hitBoxInfo);
 Entity createHurtBox(RenderSystem* renderer, vec2 pos, vec2 size);
 Entity createTitleText(RenderSystem* renderer, vec2 pos);
-Entity createLine(RenderSystem* renderer, vec2 pos, vec2 offset, vec2 scale, float angle);
 Entity createPlayerHeart(RenderSystem* renderer, vec2 pos);
 Entity createPowerUpIcon(RenderSystem* renderer, vec2 pos);
 Entity createDifficultyBar(RenderSystem* renderer, vec2 pos);
 Entity createDifficultyIndicator(RenderSystem* renderer, vec2 pos);
 Entity createScore(RenderSystem* renderer, vec2 pos);
+// the score's digits, one string of the glyph atlas
 Entity createNumber(RenderSystem* renderer, vec2 pos);
+Entity createText(RenderSystem* renderer, vec2 pos, const Text& text);
+Entity createText(RenderSystem* renderer, vec2 pos, const std::string& string, float size, TEXT_ALIGN align = TEXT_ALIGN::LEFT);
 Entity createDBFlame(RenderSystem* renderer, vec2 pos);
 Entity createDBSkull(RenderSystem* renderer, vec2 pos);
 Entity createDBSatan(RenderSystem* renderer, vec2 pos);
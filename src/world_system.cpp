@@ -28,7 +28,7 @@ Entity powerup_GUI;
 Entity difficulty_bar;
 Entity indicator;
 Entity score_text;
-std::vector<Entity> score_GUI = { };
+Entity score_number;
 std::vector<Entity> following_enemies = { };
 
 json::JSON state;
@@ -148,6 +148,7 @@ GLFWwindow *WorldSystem::create_window()
 void WorldSystem::init(RenderSystem *renderer_arg)
 {
 	this->renderer = renderer_arg;
+	ai_system.init(renderer_arg);
 	
 	// Play main menu background music
 	play_main_menu_music();
@@ -172,6 +173,8 @@ void WorldSystem::create_title_screen()
 
 	while (registry.motions.entities.size() > 0)
 		registry.remove_all_components_of(registry.motions.entities.back());
+	renderer->clearStream();
+	renderer->showParallax(false);
 
 	//these magic number are just the vertical position of where the buttons are
 	createMainMenuBackground(renderer);
@@ -188,6 +191,7 @@ void WorldSystem::create_almanac_screen() {
 
 	while (registry.motions.entities.size() > 0)
 		registry.remove_all_components_of(registry.motions.entities.back());
+	renderer->showParallax(false);
 
 	Entity helper = createHelperText(renderer, 1.f);
 	Motion& motion = registry.motions.get(helper);
@@ -221,6 +225,9 @@ void WorldSystem::create_almanac_screen() {
 bool WorldSystem::step(float elapsed_ms_since_last_update)
 {
 	if (dialogue_screen_active == 0) {
+		// the background moves with everything else, not behind dialogues
+		renderer->advanceParallax(elapsed_ms_since_last_update);
+
 		if (ddl == 4)
 		{
 			lavaPillarTimer += elapsed_ms_since_last_update;
@@ -231,12 +238,6 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			}
 		}
 
-		for (AnimationInfo& animation: registry.animated.components) {
-			if (animation.oneTimeState != -1) {
-				animation.oneTimer += elapsed_ms_since_last_update / 1000.f;
-			}
-		}
-		
 		// internal data update section
 		float expectedTimer = registry.players.get(player_hero).invulnerable_timer - elapsed_ms_since_last_update;
 		if (expectedTimer <= 0.0f)
@@ -247,46 +248,6 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		}
 		registry.players.get(player_hero).invulnerable_timer = expectedTimer;
 
-		if (registry.players.get(player_hero).invuln_type == INVULN_TYPE::HIT) 
-		{
-			for (Entity e : player_hearts_GUI) {
-				registry.renderRequests.get(e).used_texture = TEXTURE_ASSET_ID::PLAYER_HEART_STEEL;
-			}
-		}
-		else if (registry.players.get(player_hero).invuln_type == INVULN_TYPE::HEAL)
-		{
-			for (Entity e : player_hearts_GUI) {
-				registry.renderRequests.get(e).used_texture = TEXTURE_ASSET_ID::PLAYER_HEART_HEAL;
-			}
-		}
-		else
-		{
-			for (Entity e : player_hearts_GUI) {
-				registry.renderRequests.get(e).used_texture = TEXTURE_ASSET_ID::PLAYER_HEART;
-			}
-		}
-
-		switch (registry.players.get(player_hero).equipment_type)
-		{
-			case COLLECTABLE_TYPE::PICKAXE:
-				registry.renderRequests.get(powerup_GUI).used_texture = TEXTURE_ASSET_ID::PICKAXE;
-				registry.renderRequests.get(powerup_GUI).visibility = true;
-				break;
-			case COLLECTABLE_TYPE::WINGED_BOOTS:
-				registry.renderRequests.get(powerup_GUI).used_texture = TEXTURE_ASSET_ID::WINGED_BOOTS;
-				registry.renderRequests.get(powerup_GUI).visibility = true;
-				break;
-			case COLLECTABLE_TYPE::DASH_BOOTS:
-				registry.renderRequests.get(powerup_GUI).used_texture = TEXTURE_ASSET_ID::DASH_BOOTS;
-				registry.renderRequests.get(powerup_GUI).visibility = true;
-				break;
-			default:
-				registry.renderRequests.get(powerup_GUI).used_texture = TEXTURE_ASSET_ID::TEXTURE_COUNT;
-				registry.renderRequests.get(powerup_GUI).visibility = false;
-		}
-
-		changeScore(points);
-
 		ddf = max(ddf, 0.f);
 		if (ddf < 100 && ddl != 0)
 		{
@@ -362,18 +323,21 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		else
 			ddf += elapsed_ms_since_last_update / 1000.f;
 
-		// Updating window title
-
-		std::stringstream title_ss;
-		title_ss << "Points: " << points;
-		title_ss << "; Dynamic Difficulty Level: " << ddl;
-		title_ss << "; Dynamic Difficulty Factor: " << ddf;
-		glfwSetWindowTitle(window, title_ss.str().c_str());
+		// Updating the HUD and window title
+		update_hud();
 
 		// Remove debug info from the last step
 		while (registry.debugComponents.entities.size() > 0)
 			registry.remove_all_components_of(registry.debugComponents.entities.back());
 
+		if (debug) {
+			char stats[64];
+			snprintf(stats, sizeof(stats), "FPS %d DRAWN %u CULLED %u", (int)round(1000.f / elapsed_ms_since_last_update),
+					 renderer->submitted_count, renderer->culled_count);
+			Entity stats_text = createText(renderer, DEBUG_STATS_CORD, stats, 14.f, TEXT_ALIGN::RIGHT);
+			registry.debugComponents.emplace(stats_text);
+		}
+
 		// Removing out of screen entities
 		auto &motion_container = registry.motions;
 
@@ -384,15 +348,6 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		{
 			Motion &motion = motion_container.components[i];
 
-			if (motion.position.x + abs(motion.scale.x) < 0.f || motion.position.x - abs(motion.scale.x) > window_width_px || motion.position.y - abs(motion.scale.y) > window_height_px || motion.position.y + abs(motion.scale.y) < 0.f)
-			{
-				Entity e = motion_container.entities[i];
-				if (registry.parallaxBackgrounds.has(e)) {
-					ParallaxBackground &bg = registry.parallaxBackgrounds.get(e);
-					motion.position = bg.resetPosition;
-				}
-			}
-			
 			if (motion.position.y < -250 && (registry.bullets.has(motion_container.entities[i]) || registry.rockets.has(motion_container.entities[i]))) // || registry.waterBalls.has(motion_container.entities[i])
 				registry.remove_all_components_of(motion_container.entities[i]);
 			else if (registry.lasers.has(motion_container.entities[i]) && (motion.position.x > window_width_px + window_width_px / 2.f || motion.position.x < -window_width_px / 2.f || motion.position.y > window_height_px + window_height_px / 2.f || motion.position.y < -window_height_px / 2.f))
@@ -414,6 +369,10 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 
 		update_grenades(renderer, elapsed_ms_since_last_update);
 		update_explosions(elapsed_ms_since_last_update);
+
+		renderer->clearStream();
+		stream_trajectories(renderer);
+
 		// Animation Stuff
 		vec2 playerVelocity = registry.motions.get(player_hero).velocity;
 		AnimationInfo &playerAnimation = registry.animated.get(player_hero);
@@ -434,27 +393,9 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			playerAnimation.curState = 0;
 		}
 
-		for (int i = 0; i < registry.players.get(player_hero).hp; i++) {
-			Entity curHeart = player_hearts_GUI[i];
-			registry.renderRequests.get(curHeart).visibility = true;
-		}
-		for (int i = registry.players.get(player_hero).hp; i < player_hearts_GUI.size(); i++) {
-			Entity curHeart = player_hearts_GUI[i];
-			registry.renderRequests.get(curHeart).visibility = false;
-		}
-
 
 		update_collectable_timer(elapsed_ms_since_last_update, renderer, ddl);
-        move_firelings(renderer);
-        move_boulder( renderer);
-        move_ghouls(renderer, player_hero);
-        move_spitters(elapsed_ms_since_last_update, renderer);
-		if (boss && registry.boss.size()) {
-			boss_action_decision(player_hero, boss, renderer, elapsed_ms_since_last_update);
-		}
-        do_enemy_spawn(elapsed_ms_since_last_update, renderer, ddl);
-		update_graphics_all_enemies();
-
+		// the tracer only exists on difficulty levels 2 and 3, settle that before the AI steps it
 		if ((ddl == 2 || ddl == 3) && following_enemies.empty())
 		{
 			Entity newEnemy = createFollowingEnemy(renderer, find_index_from_map(vec2(12, 8)));
@@ -462,15 +403,14 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 			bfs_follow_start(vec, registry.motions.get(newEnemy).position, registry.motions.get(player_hero).position, newEnemy);
 			following_enemies.push_back(newEnemy);
 		}
-		else if ((ddl == 2 || ddl == 3) && !following_enemies.empty())
-		{
-            move_tracer(elapsed_ms_since_last_update, player_hero);
-		}
 		else if ((ddl != 2 && ddl != 3) && !following_enemies.empty())
 		{
 			registry.remove_all_components_of(following_enemies[0]);
 			following_enemies.clear();
 		}
+		ai_system.step(elapsed_ms_since_last_update, player_hero, boss);
+        do_enemy_spawn(elapsed_ms_since_last_update, renderer, ddl);
+		update_graphics_all_enemies();
 
 		// Processing the hero state
 		assert(registry.screenStates.components.size() <= 1);
@@ -505,51 +445,68 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 
 void WorldSystem::changeScore(int score)
 {
-	if (score >= 99999) 
-	{
-		for (Entity n : score_GUI)
-			registry.renderRequests.get(n).used_texture = TEXTURE_ASSET_ID::NINE;
+	char digits[8];
+	snprintf(digits, sizeof(digits), "%05d", min(score, 99999));
+	registry.texts.get(score_number).string = digits;
+}
+
+void WorldSystem::update_hud()
+{
+	const Player &player = registry.players.get(player_hero);
+
+	if (!hud.shown || player.hp != hud.hp) {
+		for (int i = 0; i < (int)player_hearts_GUI.size(); i++)
+			registry.renderRequests.get(player_hearts_GUI[i]).visibility = i < player.hp;
 	}
-	else
-	{
-		int mask = 10000;
-		for (Entity n : score_GUI)
+
+	if (!hud.shown || player.invuln_type != hud.invuln_type) {
+		TEXTURE_ASSET_ID heart = TEXTURE_ASSET_ID::PLAYER_HEART;
+		if (player.invuln_type == INVULN_TYPE::HIT)
+			heart = TEXTURE_ASSET_ID::PLAYER_HEART_STEEL;
+		else if (player.invuln_type == INVULN_TYPE::HEAL)
+			heart = TEXTURE_ASSET_ID::PLAYER_HEART_HEAL;
+		for (Entity e : player_hearts_GUI)
+			registry.renderRequests.get(e).used_texture = heart;
+	}
+
+	if (!hud.shown || player.equipment_type != hud.equipment) {
+		RenderRequest &icon = registry.renderRequests.get(powerup_GUI);
+		switch (player.equipment_type)
 		{
-			int digit = score / mask;
-			registry.renderRequests.get(n).used_texture = connectNumber(digit);
-			if (digit != 0) {
-				score -= digit * mask;
-			}
-			mask /= 10;
+			case COLLECTABLE_TYPE::PICKAXE:
+				icon.used_texture = TEXTURE_ASSET_ID::PICKAXE;
+				icon.visibility = true;
+				break;
+			case COLLECTABLE_TYPE::WINGED_BOOTS:
+				icon.used_texture = TEXTURE_ASSET_ID::WINGED_BOOTS;
+				icon.visibility = true;
+				break;
+			case COLLECTABLE_TYPE::DASH_BOOTS:
+				icon.used_texture = TEXTURE_ASSET_ID::DASH_BOOTS;
+				icon.visibility = true;
+				break;
+			default:
+				icon.used_texture = TEXTURE_ASSET_ID::TEXTURE_COUNT;
+				icon.visibility = false;
 		}
 	}
-}
 
-TEXTURE_ASSET_ID WorldSystem::connectNumber(int digit)
-{
-	switch (digit)
-	{
-	case 0:
-		return TEXTURE_ASSET_ID::ZERO;
-	case 1:
-		return TEXTURE_ASSET_ID::ONE;
-	case 2:
-		return TEXTURE_ASSET_ID::TWO;
-	case 3:
-		return TEXTURE_ASSET_ID::THREE;
-	case 4:
-		return TEXTURE_ASSET_ID::FOUR;
-	case 5:
-		return TEXTURE_ASSET_ID::FIVE;
-	case 6:
-		return TEXTURE_ASSET_ID::SIX;
-	case 7:
-		return TEXTURE_ASSET_ID::SEVEN;
-	case 8:
-		return TEXTURE_ASSET_ID::EIGHT;
-	default:
-		return TEXTURE_ASSET_ID::NINE;
+	if (!hud.shown || points != hud.points)
+		changeScore(points);
+
+	// the factor is shown to a tenth so the title changes a few times a second rather than every frame
+	char title[128];
+	snprintf(title, sizeof(title), "Points: %u; Dynamic Difficulty Level: %d; Dynamic Difficulty Factor: %.1f", points, ddl, ddf);
+	if (hud.title != title) {
+		hud.title = title;
+		glfwSetWindowTitle(window, title);
 	}
+
+	hud.shown = true;
+	hud.hp = player.hp;
+	hud.invuln_type = player.invuln_type;
+	hud.equipment = player.equipment_type;
+	hud.points = points;
 }
 
 void WorldSystem::show_dialogue(int dialogue_number)
@@ -568,10 +525,7 @@ void WorldSystem::show_dialogue(int dialogue_number)
 			registry.motions.get(difficulty_bar).position = DB_SATAN_CORD;
 			registry.renderRequests.get(difficulty_bar).scale = { 220.f, 128.f };
 			registry.renderRequests.get(score_text).visibility = true;
-			for (Entity n : score_GUI)
-			{
-				registry.renderRequests.get(n).visibility = true;
-			}
+			registry.texts.get(score_number).visibility = true;
 		}
 	}
 
@@ -672,6 +626,7 @@ void WorldSystem::restart_game()
 	// All that have a motion, we could also iterate over all, ... but that would be more cumbersome
 	while (registry.motions.entities.size() > 0)
 		registry.remove_all_components_of(registry.motions.entities.back());
+	renderer->clearStream();
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 	// add bg
@@ -703,7 +658,6 @@ void WorldSystem::restart_game()
 	should_score_prepare_to_show = false;
 	player_color = registry.colors.get(player_hero);
 	player_hearts_GUI.clear();
-	score_GUI.clear();
 
 	create_inGame_GUIs();
 
@@ -888,10 +842,7 @@ void WorldSystem::load_game() {
 				registry.motions.get(difficulty_bar).position = DB_SATAN_CORD;
 				registry.renderRequests.get(difficulty_bar).scale = { 220.f, 128.f };
 				registry.renderRequests.get(score_text).visibility = true;
-				for (Entity n : score_GUI)
-				{
-					registry.renderRequests.get(n).visibility = true;
-				}
+				registry.texts.get(score_number).visibility = true;
 				break;
 		}
 		points = state["score"].ToInt();
@@ -1007,23 +958,14 @@ void WorldSystem::create_pause_screen() {
 }
 
 void WorldSystem::create_parallax_background() {
-	parallax_background_color = createParallaxItem(renderer, {600, 400}, TEXTURE_ASSET_ID::BACKGROUND_COLOR);
-	parallax_moon = createParallaxItem(renderer, {580, 400}, TEXTURE_ASSET_ID::PARALLAX_MOON);
-	parallax_clouds_far_1 = createParallaxItem(renderer, {600, 400}, TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR);
-	parallax_clouds_far_2 = createParallaxItem(renderer, {-600, 400}, TEXTURE_ASSET_ID::PARALLAX_CLOUDS_FAR);
-	parallax_clouds_close_1 = createParallaxItem(renderer, {600, 400}, TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE);
-	parallax_clouds_close_2 = createParallaxItem(renderer, {-600, 400}, TEXTURE_ASSET_ID::PARALLAX_CLOUDS_CLOSE);
-	parallax_rain_1 = createParallaxItem(renderer, {0, 1200}, TEXTURE_ASSET_ID::PARALLAX_RAIN);
-	parallax_rain_2 = createParallaxItem(renderer, {600, 800}, TEXTURE_ASSET_ID::PARALLAX_RAIN);
-	parallax_rain_3 = createParallaxItem(renderer, {400, 400}, TEXTURE_ASSET_ID::PARALLAX_RAIN);
-	parallax_rain_4 = createParallaxItem(renderer, {800, 100}, TEXTURE_ASSET_ID::PARALLAX_RAIN);
-	parallax_background = createParallaxItem(renderer, {600, 400}, TEXTURE_ASSET_ID::BACKGROUND);
-	parallax_lava_1 = createParallaxItem(renderer, {600, 813}, TEXTURE_ASSET_ID::PARALLAX_LAVA);
-	parallax_lava_2 = createParallaxItem(renderer, {-600, 813}, TEXTURE_ASSET_ID::PARALLAX_LAVA);
-	parallax_lava_3 = createParallaxItem(renderer, {-1200, 813}, TEXTURE_ASSET_ID::PARALLAX_LAVA);
+	// the layers are drawn by the renderer, only the lava is part of the game
+	renderer->showParallax(true);
+	lava = createLava(renderer, LAVA_CORD);
 }
 
 void WorldSystem::create_inGame_GUIs() {
+	// new entities, everything has to be pushed to them again
+	hud = HudState();
 	float heartPosition = HEART_START_POS;
 	for (int i = 0; i < registry.players.get(player_hero).hp_max; i++) {
 		player_hearts_GUI.push_back(createPlayerHeart(renderer, { heartPosition, HEART_Y_CORD }));
@@ -1033,11 +975,7 @@ void WorldSystem::create_inGame_GUIs() {
 	difficulty_bar = createDifficultyBar(renderer, DIFF_BAR_CORD);
 	indicator = createDifficultyIndicator(renderer, INDICATOR_START_CORD);
 	score_text = createScore(renderer, SCORE_CORD);
-	float numberPosition = NUMBER_START_POS;
-	for (int i = 0; i < 5; i++) {
-		score_GUI.push_back(createNumber(renderer, { numberPosition, NUMBER_Y_CORD }));
-		numberPosition += NUMBER_GAP;
-	}
+	score_number = createNumber(renderer, NUMBER_CORD);
 }
 
 // Compute collisions between entities
@@ -1079,9 +1017,6 @@ void WorldSystem::handle_collisions()
 					registry.deathTimers.emplace(entity);
 					
 					if (player.hasWeapon) {
-						if (registry.grenadeLaunchers.has(player.weapon))
-							for(Entity line: registry.grenadeLaunchers.get(player.weapon).trajectory)
-								registry.remove_all_components_of(line);
 						registry.remove_all_components_of(player.weapon);
 					}
 					player.hasWeapon = false;
@@ -1172,18 +1107,6 @@ void WorldSystem::handle_collisions()
 				if ((solid_motion.position.y <= block_motion.position.y - block_motion.scale.y / 2.f - solid_motion.scale.y / 2.f)) {
 					if (registry.players.has(entity_other)) {
 						registry.players.get(entity_other).jumps = MAX_JUMPS + (registry.players.get(entity_other).equipment_type == COLLECTABLE_TYPE::WINGED_BOOTS ? 1 : 0);
-					} else if (registry.ghouls.has(entity_other) && registry.ghouls.get(entity_other).left_x == -1.f) {
-						registry.animated.get(entity_other).oneTimeState = 5;
-						registry.animated.get(entity_other).oneTimer = 0;
-						registry.colors.insert(entity_other, {1, .8f, .8f});
-						registry.ghouls.get(entity_other).left_x = block_motion.position.x - scale1.x;
-						registry.ghouls.get(entity_other).right_x = block_motion.position.x + scale1.x;
-					} else if (registry.spitterEnemies.has(entity_other) && registry.spitterEnemies.get(entity_other).left_x == -1.f) {
-						//registry.colors.insert(entity_other, { 1, .8f, .8f });
-						registry.animated.get(entity_other).oneTimeState = 3;
-						registry.animated.get(entity_other).oneTimer = 0;
-						registry.spitterEnemies.get(entity_other).left_x = max(block_motion.position.x - scale1.x, 70.f);
-						registry.spitterEnemies.get(entity_other).right_x = min(block_motion.position.x + scale1.x, 1125.f);
 					} else if (registry.waterBalls.has(entity_other)) {
 						solid_motion.angle = M_PI/2;
 						solid_motion.position.y = block_motion.position.y - scale1.y - scale2.x;
@@ -1216,8 +1139,7 @@ void WorldSystem::handle_collisions()
 				if (registry.waterBalls.has(entity_other)) {
 					registry.waterBalls.get(entity_other).drawing = false;
 					registry.waterBalls.get(entity_other).state = -1;
-					for (Entity line: registry.waterBalls.get(entity_other).trajectory)
-						registry.remove_all_components_of(line);
+					registry.waterBalls.get(entity_other).show_trajectory = false;
 					registry.animated.get(entity_other).oneTimeState = 2;
 					registry.animated.get(entity_other).oneTimer = 0;
 					registry.weaponHitBoxes.get(entity_other).isActive = false;
@@ -1242,13 +1164,8 @@ void WorldSystem::handle_collisions()
 				}
 				projectile_motion.velocity = vec2(projectile_motion.velocity.x * projectile.friction_x, projectile_motion.velocity.y * projectile.friction_y);
 			} 
-		} else if (registry.parallaxBackgrounds.has(entity) && registry.renderRequests.get(entity).used_texture == TEXTURE_ASSET_ID::PARALLAX_LAVA) {
+		} else if (registry.lavas.has(entity)) {
 			if (registry.bullets.has(entity_other) || registry.rockets.has(entity_other) || registry.grenades.has(entity_other) || registry.spitterBullets.has(entity_other) || registry.collectables.has(entity_other) || registry.waterBalls.has(entity_other)) {
-				if (registry.waterBalls.has(entity_other)) {
-					registry.waterBalls.get(entity_other).drawing = false;
-					for (Entity line: registry.waterBalls.get(entity_other).trajectory)
-						registry.remove_all_components_of(line);
-				}
 				registry.remove_all_components_of(entity_other);
 			} else if (registry.players.has(entity_other) && !registry.deathTimers.has(entity_other)) {
 				// Scream, reset timer, and make the hero fall
@@ -1256,9 +1173,6 @@ void WorldSystem::handle_collisions()
 				Player& player = registry.players.get(entity_other);
 			
 				if (player.hasWeapon) {
-					if (registry.grenadeLaunchers.has(player.weapon))
-						for(Entity line: registry.grenadeLaunchers.get(player.weapon).trajectory)
-							registry.remove_all_components_of(line);
 					registry.remove_all_components_of(player.weapon);
 				}
 				player.hasWeapon = false;
@@ -1331,6 +1245,19 @@ void WorldSystem::update_health_bar()
 // On key callback
 void WorldSystem::on_key(int key, int, int action, int mod)
 {
+	// F8 starts and stops recording frames, as PNG or with shift as raw RGBA.
+	// F9 cycles the resolution the scene is drawn at, F10 the filter scaling it to the window
+	if (key == GLFW_KEY_F8 && action == GLFW_PRESS)
+		renderer->toggleRecording(mod & GLFW_MOD_SHIFT ? CAPTURE_FORMAT::RAW : CAPTURE_FORMAT::PNG);
+	if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+		RENDER_RESOLUTION next = (RENDER_RESOLUTION)(((int)renderer->getRenderResolution() + 1) % (int)RENDER_RESOLUTION::RESOLUTION_COUNT);
+		renderer->setRenderResolution(next, renderer->getUpscaleFilter());
+	}
+	if (key == GLFW_KEY_F10 && action == GLFW_PRESS) {
+		UPSCALE_FILTER next = (UPSCALE_FILTER)(((int)renderer->getUpscaleFilter() + 1) % (int)UPSCALE_FILTER::FILTER_COUNT);
+		renderer->setRenderResolution(renderer->getRenderResolution(), next);
+	}
+
 	if (isTitleScreen) {
 		
 		return;
@@ -1463,6 +1390,22 @@ void WorldSystem::on_key(int key, int, int action, int mod)
 			show_dialogue(1);
 		}
 
+		// A/B the boss planners, [ and ] halve and double the MCTS budget
+		if (key == GLFW_KEY_P && action == GLFW_PRESS && debug) {
+			toggle_boss_planner();
+		}
+		if (key == GLFW_KEY_LEFT_BRACKET && action == GLFW_PRESS && debug) {
+			scale_boss_planner_budget(0.5f);
+		}
+		if (key == GLFW_KEY_RIGHT_BRACKET && action == GLFW_PRESS && debug) {
+			scale_boss_planner_budget(2.f);
+		}
+
+		// cycle how often ghouls and spitters decide
+		if (key == GLFW_KEY_T && action == GLFW_PRESS && debug) {
+			ai_system.cycle_think_rates();
+		}
+
 	}
 
 	// Resetting game
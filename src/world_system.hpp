@@ -26,7 +26,8 @@
 const float ANIMATION_SPEED_FACTOR = 10.0f;
 
 // Game configuration
-static float spitter_projectile_delay_ms = 5000.f;
+// set by adjust_difficulty, read by the AI system
+extern float spitter_projectile_delay_ms;
 static float spawn_delay_variance = 0.6;
 static size_t spawn_delay = 6000;
 const size_t BOSS_MAX_GHOULS = 14;
@@ -51,15 +52,30 @@ const vec2 DB_BOSS_CORD = { 140.f, 717.5f };
 const vec2 INDICATOR_START_CORD = { 35.f, 710.f };
 const float INDICATOR_VELOCITY = 55.f / 100.f;
 const vec2 SCORE_CORD = { 1050.f, 700.f };
-const float NUMBER_START_POS = 992.f;
+// the score's digits, NUMBER_GAP apart
+const vec2 NUMBER_CORD = { 1050.f, 740.f };
 const float NUMBER_GAP = 29.f;
-const float NUMBER_Y_CORD = 740.f;
+const float NUMBER_HEIGHT = 29.f;
+const vec2 DEBUG_STATS_CORD = { 1190.f, 20.f };
 const vec2 DB_SATAN_CORD = { 140.f, 725.f };
+const vec2 LAVA_CORD = { 600.f, 813.f };
 const float LAVA_PILLAR_SPAWN_DELAY = 15000.f;
 const uint MDP_HORIZON = 2;
 const float MDP_DISCOUNT_FACTOR = 0.9f;
 const float MDP_BASE_REWARD = 100;
 
+// What the HUD last showed, its entities and the window title are only written when one of these changes
+struct HudState
+{
+	// false until the HUD entities have been filled in once
+	bool shown = false;
+	int hp = 0;
+	INVULN_TYPE invuln_type = INVULN_TYPE::NONE;
+	COLLECTABLE_TYPE equipment = COLLECTABLE_TYPE::COLLECTABLE_COUNT;
+	unsigned int points = 0;
+	std::string title;
+};
+
 enum SpawnableEnemyType {
         FIRELINGS = 0,
         GHOULS = FIRELINGS + 1,
@@ -97,8 +113,6 @@ public:
   
 	void changeScore(int score);
 
-	TEXTURE_ASSET_ID connectNumber(int digit);
-
 	void show_dialogue(int dialogue_number);
 	TEXTURE_ASSET_ID connectDialogue(int digit);
 
@@ -141,6 +155,9 @@ private:
 	void create_title_screen();
 	void create_almanac_screen();
 	void create_inGame_GUIs();
+	// Pushes whatever changed since the last call to the HUD and window title
+	void update_hud();
+	HudState hud;
 	// OpenGL window handle
 	GLFWwindow *window;
 
@@ -149,23 +166,11 @@ private:
 	
 	// backgrounds
     void create_parallax_background();
-	Entity parallax_background;
-	Entity parallax_background_color;
-	Entity parallax_clouds_far_1;
-	Entity parallax_clouds_far_2;
-	Entity parallax_clouds_close_1;
-	Entity parallax_clouds_close_2;
-	Entity parallax_rain_1;
-	Entity parallax_rain_2;
-	Entity parallax_rain_3;
-	Entity parallax_rain_4;
-	Entity parallax_moon;
-	Entity parallax_lava_1;
-	Entity parallax_lava_2;
-	Entity parallax_lava_3;
+	Entity lava;
 
 	// Game state
 	RenderSystem *renderer;
+	AISystem ai_system;
 	Entity player_hero;
     Entity boss;
 };
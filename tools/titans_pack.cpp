@@ -0,0 +1,172 @@
+// Bakes the game's assets into one archive the game maps at startup, see src/asset_archive.hpp.
+// Usage: titans_pack <data directory> <output archive> <asset paths relative to the data directory>...
+// The pack_assets target runs it with every texture, sound effect and collision mesh.
+
+// internal
+#include "asset_archive.hpp"
+#include "components.hpp"
+
+#include "../ext/stb_image/stb_image.h"
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+// stlib
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct PackedAsset
+{
+	AssetEntry entry;
+	std::vector<unsigned char> data;
+};
+
+static bool ends_with(const std::string &text, const std::string &suffix)
+{
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static void append(std::vector<unsigned char> &data, const void *bytes, size_t size)
+{
+	const unsigned char *begin = (const unsigned char *)bytes;
+	data.insert(data.end(), begin, begin + size);
+}
+
+static bool pack_texture(const std::string &path, PackedAsset &asset)
+{
+	int width, height;
+	stbi_uc *pixels = stbi_load(path.c_str(), &width, &height, NULL, 4);
+	if (!pixels)
+		return false;
+	asset.entry.type = ASSET_TYPE::TEXTURE;
+	asset.entry.width = (uint32_t)width;
+	asset.entry.height = (uint32_t)height;
+	append(asset.data, pixels, (size_t)width * height * 4);
+	stbi_image_free(pixels);
+	return true;
+}
+
+static bool pack_sound(const std::string &path, PackedAsset &asset)
+{
+	SDL_AudioSpec spec;
+	Uint8 *samples;
+	Uint32 length;
+	if (!SDL_LoadWAV(path.c_str(), &spec, &samples, &length))
+		return false;
+
+	SDL_AudioCVT cvt;
+	int needs_conversion = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+											 AUDIO_S16SYS, ASSET_AUDIO_CHANNELS, ASSET_AUDIO_FREQUENCY);
+	if (needs_conversion < 0) {
+		SDL_FreeWAV(samples);
+		return false;
+	}
+	std::vector<unsigned char> pcm((size_t)length * std::max(cvt.len_mult, 1));
+	memcpy(pcm.data(), samples, length);
+	SDL_FreeWAV(samples);
+	size_t converted_length = length;
+	if (needs_conversion > 0) {
+		cvt.len = (int)length;
+		cvt.buf = pcm.data();
+		if (SDL_ConvertAudio(&cvt) < 0)
+			return false;
+		converted_length = (size_t)cvt.len_cvt;
+	}
+	pcm.resize(converted_length);
+
+	asset.entry.type = ASSET_TYPE::SOUND;
+	asset.data = std::move(pcm);
+	return true;
+}
+
+static bool pack_collision_mesh(const std::string &path, PackedAsset &asset)
+{
+	CollisionMesh mesh;
+	if (!CollisionMesh::loadFromOBJFile(path, mesh.vertices, mesh.edges, mesh.original_size))
+		return false;
+	asset.entry.type = ASSET_TYPE::COLLISION_MESH;
+	asset.entry.width = (uint32_t)mesh.vertices.size();
+	asset.entry.height = (uint32_t)mesh.edges.size();
+	append(asset.data, &mesh.original_size, sizeof(vec2));
+	append(asset.data, mesh.vertices.data(), sizeof(ColoredVertex) * mesh.vertices.size());
+	for (const std::pair<int, int> &edge : mesh.edges) {
+		int32_t indices[2] = { edge.first, edge.second };
+		append(asset.data, indices, sizeof(indices));
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s <data directory> <output archive> <assets>...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	const std::string data_directory = argv[1];
+
+	std::vector<PackedAsset> assets;
+	for (int i = 3; i < argc; i++) {
+		const std::string name = argv[i];
+		if (name.size() >= ASSET_NAME_LENGTH) {
+			fprintf(stderr, "Asset name too long: %s\n", name.c_str());
+			return EXIT_FAILURE;
+		}
+		PackedAsset asset = {};
+		strncpy(asset.entry.name, name.c_str(), ASSET_NAME_LENGTH);
+
+		const std::string path = data_directory + "/" + name;
+		bool packed;
+		if (ends_with(name, ".png"))
+			packed = pack_texture(path, asset);
+		else if (ends_with(name, ".wav"))
+			packed = pack_sound(path, asset);
+		else if (ends_with(name, ".obj"))
+			packed = pack_collision_mesh(path, asset);
+		else {
+			fprintf(stderr, "Don't know how to pack %s\n", name.c_str());
+			return EXIT_FAILURE;
+		}
+		if (!packed || !asset_file_stamp(path, asset.entry.source_size, asset.entry.source_mtime)) {
+			fprintf(stderr, "Could not pack %s\n", path.c_str());
+			return EXIT_FAILURE;
+		}
+		assets.push_back(std::move(asset));
+	}
+
+	// the game binary searches the entries
+	std::sort(assets.begin(), assets.end(), [](const PackedAsset &a, const PackedAsset &b) {
+		return strncmp(a.entry.name, b.entry.name, ASSET_NAME_LENGTH) < 0;
+	});
+	uint64_t offset = sizeof(AssetArchiveHeader) + sizeof(AssetEntry) * assets.size();
+	for (PackedAsset &asset : assets) {
+		offset = (offset + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT;
+		asset.entry.offset = offset;
+		asset.entry.size = asset.data.size();
+		offset += asset.data.size();
+	}
+
+	FILE *file = fopen(argv[2], "wb");
+	if (!file) {
+		fprintf(stderr, "Could not open %s for writing\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+	AssetArchiveHeader header = { ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_VERSION, (uint32_t)assets.size(), 0 };
+	fwrite(&header, sizeof(header), 1, file);
+	for (const PackedAsset &asset : assets)
+		fwrite(&asset.entry, sizeof(AssetEntry), 1, file);
+	const char padding[ASSET_ALIGNMENT] = {};
+	for (const PackedAsset &asset : assets) {
+		fwrite(padding, 1, (size_t)(asset.entry.offset - ftell(file)), file);
+		fwrite(asset.data.data(), 1, asset.data.size(), file);
+	}
+	bool failed = ferror(file) != 0;
+	fclose(file);
+	if (failed) {
+		fprintf(stderr, "Could not write %s\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+	printf("Packed %zu assets into %s (%llu bytes)\n", assets.size(), argv[2], (unsigned long long)offset);
+	return EXIT_SUCCESS;
+}